@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Batch.hpp"
+#include "CubeState.hpp"
+#include "MoveHistory.hpp"
+#include "Solver.hpp"
+
+// INPUT IS READ IN BLOCKS (THE NEXT ONE WHILE THE CURRENT ONE IS BEING SOLVED) AND SPLIT INTO CHUNKS,
+// A CHUNK IS WHAT A THREAD CLAIMS OR STEALS AT ONCE
+static const size_t BLOCK_LINES = 65536;
+static const size_t CHUNK_LINES = 8;
+
+struct BatchLine {
+	std::string text;
+	std::string result;
+	bool ok = true;
+	float seconds = 0.0f;
+};
+
+struct BatchSettings {
+	bool verify = false;
+	SolveOptions solve;
+};
+
+// APPLIES THE LINE TO A SOLVED CUBE, THEN EITHER CHECKS IT CAME BACK SOLVED OR APPENDS A (CANONICAL) SOLUTION
+static void process_line(BatchLine& line, const BatchSettings& settings) {
+	auto start = std::chrono::steady_clock::now();
+	line.ok = true;
+	line.result.clear();
+
+	CubeState state;
+	for (char c : line.text) {
+		if (c == ' ' || c == '\t') continue;
+		int move = move_from_char(c);
+		if (move < 0) {
+			line.ok = false;
+			line.result = std::string("error: not a move: ") + c;
+			break;
+		}
+		apply_move(state, move);
+	}
+
+	if (line.ok && settings.verify) {
+		line.ok = is_solved(state);
+		line.result = line.ok ? "solved" : "unsolved";
+	} else if (line.ok) {
+		MoveHistory solution;
+		for (int move : solve(state, settings.solve)) solution.push_move(move);
+		line.result = line.text;
+		line.result += '\t';
+		line.result += solution.letters;
+	}
+	line.seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
+
+// WORK STEALING POOL: EVERY WORKER OWNS A QUEUE OF CHUNKS AND TAKES FROM ITS FRONT (THE EARLIEST LINES, WHICH THE
+// WRITER NEEDS FIRST), A WORKER WHOSE QUEUE RAN DRY STEALS FROM THE BACK OF ANOTHER ONE (THE LINES NEEDED LAST)
+struct BatchPool {
+	struct ChunkQueue {
+		std::mutex mutex;
+		std::deque<int> chunks;
+	};
+
+	explicit BatchPool(int threads, const BatchSettings& settings);
+	BatchPool(const BatchPool&) = delete;
+	BatchPool& operator=(const BatchPool&) = delete;
+	~BatchPool();
+
+	// HANDS lines TO THE WORKERS, THEY STAY UNTOUCHED BY THE CALLER UNTIL EVERY CHUNK HAS BEEN WAITED FOR
+	void publish();
+	int chunk_count() const { return (int)((lines.size() + CHUNK_LINES - 1) / CHUNK_LINES); }
+	void wait_chunk(int chunk);
+
+	BatchSettings settings;
+	std::vector<BatchLine> lines;
+
+	std::vector<ChunkQueue> queues;
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable chunk_finished;
+	std::vector<uint8_t> chunk_done;
+	uint64_t generation = 0;
+	bool stopping = false;
+
+	int take_chunk(int self);
+	void worker_loop(int self);
+};
+
+BatchPool::BatchPool(int threads, const BatchSettings& settings) : settings(settings), queues(threads) {
+	for (int i = 0; i < threads; i++) {
+		workers.emplace_back(&BatchPool::worker_loop, this, i);
+	}
+}
+
+BatchPool::~BatchPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers) worker.join();
+}
+
+void BatchPool::publish() {
+	int count = chunk_count();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		chunk_done.assign(count, 0);
+
+		// CONSECUTIVE CHUNKS GO TO DIFFERENT WORKERS SO THE FRONT OF THE BLOCK IS WORKED ON FIRST
+		for (int chunk = 0; chunk < count; chunk++) {
+			ChunkQueue& queue = queues[chunk % queues.size()];
+			std::lock_guard<std::mutex> queue_lock(queue.mutex);
+			queue.chunks.push_back(chunk);
+		}
+		generation++;
+	}
+	wake.notify_all();
+}
+
+void BatchPool::wait_chunk(int chunk) {
+	std::unique_lock<std::mutex> lock(mutex);
+	chunk_finished.wait(lock, [&] { return chunk_done[chunk] != 0; });
+}
+
+// OWN QUEUE FIRST, THEN THE OTHERS IN TURN, -1 ONCE EVERY QUEUE IS EMPTY (NOTHING IS ADDED WITHIN A GENERATION)
+int BatchPool::take_chunk(int self) {
+	int n = (int)queues.size();
+	for (int k = 0; k < n; k++) {
+		ChunkQueue& queue = queues[(self + k) % n];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.chunks.empty()) continue;
+		int chunk;
+		if (k == 0) {
+			chunk = queue.chunks.front();
+			queue.chunks.pop_front();
+		} else {
+			chunk = queue.chunks.back();
+			queue.chunks.pop_back();
+		}
+		return chunk;
+	}
+	return -1;
+}
+
+void BatchPool::worker_loop(int self) {
+	uint64_t seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+		}
+
+		for (int chunk = take_chunk(self); chunk >= 0; chunk = take_chunk(self)) {
+			size_t end = std::min(lines.size(), (chunk + 1) * CHUNK_LINES);
+			for (size_t i = chunk * CHUNK_LINES; i < end; i++) {
+				process_line(lines[i], settings);
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				chunk_done[chunk] = 1;
+			}
+			chunk_finished.notify_all();
+		}
+	}
+}
+
+// READS UP TO BLOCK_LINES LINES (TRAILING WHITESPACE AND CR STRIPPED), REUSING THE STRINGS ALREADY IN block
+static void read_block(std::istream& input, std::vector<BatchLine>& block) {
+	block.resize(BLOCK_LINES);
+	size_t count = 0;
+	while (count < BLOCK_LINES && std::getline(input, block[count].text)) {
+		std::string& text = block[count].text;
+		while (!text.empty() && std::strchr(" \t\r", text.back())) text.pop_back();
+		count++;
+	}
+	block.resize(count);
+}
+
+static double percentile(std::vector<float>& values, double p) {
+	if (values.empty()) return 0.0;
+	size_t index = std::min(values.size() - 1, (size_t)(p * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+int run_batch(int argc, char** argv) {
+	const char* input_path = nullptr;
+	int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+	BatchSettings settings;
+
+	// THE FIRST SOLUTION FOUND, AS ON THE WALL: THROUGHPUT MATTERS MORE HERE THAN THE LAST MOVE OR TWO
+	settings.solve.target_length = 30;
+	settings.solve.timeout_seconds = 0.0;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+			input_path = argv[++i];
+		} else if (std::strcmp(argv[i], "--verify") == 0) {
+			settings.verify = true;
+		} else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+			settings.solve.target_length = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+			settings.solve.timeout_seconds = std::atof(argv[++i]);
+		}
+	}
+	if (CUBE_N != 3) {
+		std::cerr << "--batch needs a 3x3 build (CUBE_SIZE=3)\n";
+		return 1;
+	}
+	if (threads <= 0) {
+		std::cerr << "--threads must be positive\n";
+		return 1;
+	}
+	if (settings.solve.timeout_seconds < 0.0) {
+		std::cerr << "--timeout must not be negative\n";
+		return 1;
+	}
+
+	std::ios::sync_with_stdio(false);
+	std::ifstream file;
+	if (input_path && std::strcmp(input_path, "-") != 0) {
+		file.open(input_path);
+		if (!file) {
+			std::cerr << "cannot open " << input_path << "\n";
+			return 1;
+		}
+	}
+	std::istream& input = file.is_open() ? file : std::cin;
+
+	using Clock = std::chrono::steady_clock;
+	auto start = Clock::now();
+	if (!settings.verify) load_solver_tables(default_solver_cache_path());
+	double load_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	BatchPool pool(threads, settings);
+	std::vector<BatchLine> next;
+	std::vector<float> latencies;
+	std::string out;
+	size_t failed = 0;
+
+	read_block(input, pool.lines);
+	while (!pool.lines.empty()) {
+		pool.publish();
+		read_block(input, next);
+
+		// WRITE CHUNKS IN INPUT ORDER AS SOON AS EACH ONE IS DONE
+		for (int chunk = 0; chunk < pool.chunk_count(); chunk++) {
+			pool.wait_chunk(chunk);
+			out.clear();
+			size_t end = std::min(pool.lines.size(), (chunk + 1) * CHUNK_LINES);
+			for (size_t i = chunk * CHUNK_LINES; i < end; i++) {
+				const BatchLine& line = pool.lines[i];
+				out += line.result;
+				out += '\n';
+				latencies.push_back(line.seconds);
+				failed += !line.ok;
+			}
+			std::fwrite(out.data(), 1, out.size(), stdout);
+		}
+		std::fflush(stdout);
+		std::swap(pool.lines, next);
+	}
+
+	// THROUGHPUT COUNTS WALL CLOCK TIME INCLUDING INPUT AND OUTPUT, LATENCY IS THE TIME SPENT ON EACH LINE
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count() - load_seconds;
+	size_t count = latencies.size();
+	std::fprintf(stderr, "%s %zu cubes (%zu %s) in %.3f s on %d threads: %.0f cubes/s, tables %.1f ms\n",
+			settings.verify ? "verified" : "solved", count, failed, settings.verify ? "not solved or invalid" : "invalid",
+			seconds, threads, seconds > 0.0 ? count / seconds : 0.0, load_seconds * 1000.0);
+	std::fprintf(stderr, "latency ms: p50 %.3f p90 %.3f p99 %.3f max %.3f\n",
+			percentile(latencies, 0.50) * 1000.0, percentile(latencies, 0.90) * 1000.0,
+			percentile(latencies, 0.99) * 1000.0, percentile(latencies, 1.0) * 1000.0);
+	return failed == 0 ? 0 : 1;
+}
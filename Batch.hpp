@@ -0,0 +1,6 @@
+#pragma once
+
+// HEADLESS BATCH MODE: ONE MOVE SEQUENCE (MOVE LIST LETTERS, SPACES IGNORED) PER INPUT LINE, SOLVED OR VERIFIED ON
+// A WORK STEALING THREAD POOL, RESULTS ARE STREAMED TO STDOUT IN INPUT ORDER AND TIMINGS GO TO STDERR
+// USAGE: RubiksRays --batch [--input FILE] [--verify] [--threads N] [--target N] [--timeout SECONDS]
+int run_batch(int argc, char** argv);
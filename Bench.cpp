@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <ftxui/screen/screen.hpp>
+#include <glm/glm.hpp>
+#include "Bench.hpp"
+#include "Render.hpp"
+#include "Transform.hpp"
+#include "Output.hpp"
+#include "Solver.hpp"
+#include "Wall.hpp"
+
+struct BenchSize {
+	int width, height;
+};
+
+// PER STAGE TOTALS IN SECONDS
+struct BenchTimes {
+	double transform = 0.0;
+	double geometry = 0.0;
+	double raster = 0.0;
+	double resolve = 0.0;
+	double to_string = 0.0;
+	double diff = 0.0;
+	double total = 0.0;
+	size_t bytes = 0;
+	size_t diff_bytes = 0;
+	long triangles = 0;
+	long culled_cubes = 0;
+	long lod_cubes = 0;
+
+	// RASTER WORK SUMMED OVER THE FRAMES AND THE CELLS LEFT COVERED AT THE END OF EACH
+	RasterCounts counts;
+	long covered = 0;
+};
+
+// RENDERS frames FRAMES AT ONE SIZE, TIMING EACH STAGE OF THE PIPELINE
+// still HOLDS THE CAMERA AT THE RESTING VIEW, SO TURNS REDRAW ONLY THE TURNING SLICE OVER THE STATIC LAYER
+// A wall (WHEN IT HAS CUBES) IS STEPPED AND DRAWN INSTEAD OF THE SCRIPTED CUBE
+static BenchTimes bench_size(BenchSize size, int frames, int threads, bool still, OutputMode mode, CellMode cell_mode, CubeWall& wall) {
+	using Clock = std::chrono::steady_clock;
+	auto seconds = [](Clock::time_point a, Clock::time_point b) {
+		return std::chrono::duration<double>(b - a).count();
+	};
+
+	FrameContext context;
+	std::unique_ptr<FrameEncoder> encoder = make_encoder(mode);
+	ftxui::Screen reference = ftxui::Screen(size.width, size.height);
+	context.cell_mode = cell_mode;
+	context.resize(size.width, size.height);
+	context.tiles.set_threads(threads);
+	Framebuffer& screen = context.screen;
+
+	Cube cube = MakeCube();
+	Stickers cube_state = solved_stickers();
+	TurnAnimations animations;
+
+	// SCRIPTED MOVES, A NEW ONE EVERY 12 FRAMES SO MOST FRAMES ARE MID ANIMATION
+	// (PLUS INNER LAYER TURNS ON CUBES THAT HAVE THEM)
+	std::string script = "ruRUfdFDlbLBxyzXYZ";
+	if (CUBE_N > 2) script += "2r2U2f";
+	std::vector<Move> moves;
+	for (size_t at = 0; at < script.size();) {
+		Move move;
+		if (!read_move(script, at, move)) break;
+		moves.push_back(move);
+	}
+	const int frames_per_move = 12;
+
+	BenchTimes times;
+	render_stats = RenderStats{};
+	render_stats.enabled = true;
+
+	glm::mat4 proj = camera_projection(size.width, size.height);
+	if (!wall.cubes.empty()) wall.layout(proj);
+
+	for (int frame = 0; frame < frames; frame++) {
+		auto t0 = Clock::now();
+
+		// TRANSFORM STAGE (ONE SIMULATION STEP OF THE WALL PER FRAME)
+		bool starting_move = frame % frames_per_move == 0;
+		if (!wall.cubes.empty()) {
+			wall.step();
+		} else if (starting_move) {
+			const Move& move = moves[frame / frames_per_move % moves.size()];
+			animations.finish(cube, cube_state);
+			animations.start(cube, cube_state, move);
+		} else {
+			animations.advance(cube, cube_state, 1.0);
+		}
+
+		// CAMERA SWEEP ACROSS THE PSEUDO-ISOMETRIC RANGE
+		float yaw = still ? 0.6f : 0.8f * std::sin(frame * 0.02f);
+		float pitch = still ? 0.6f : 0.5f * std::sin(frame * 0.013f);
+		float distance = wall.cubes.empty() ? 0.0f : wall.camera_distance(proj);
+		glm::mat4 view = camera_view(pitch, yaw, distance);
+		auto t1 = Clock::now();
+
+		// RENDER STAGE (RASTERIZATION AND SUB-CELL RESOLVE ARE TIMED INSIDE render_cube)
+		double raster_before = render_stats.raster_seconds;
+		double resolve_before = render_stats.resolve_seconds;
+		if (!wall.cubes.empty()) {
+			wall.render(context, proj, view);
+		} else {
+			render_cube(cube, context, proj, view);
+		}
+		auto t2 = Clock::now();
+		double raster = render_stats.raster_seconds - raster_before;
+		double resolve = render_stats.resolve_seconds - resolve_before;
+
+		// SERIALIZATION STAGE, A FULL FRAME ftxui ToString FOR REFERENCE (COPY INCLUDED) AND THE SELECTED ENCODER
+		copy_to_screen(screen, reference);
+		std::string full = reference.ToString();
+		auto t3 = Clock::now();
+		const std::string& diff = encoder->encode(screen);
+		auto t4 = Clock::now();
+
+		// OUTSIDE THE TIMED STAGES, SCANNING THE ZBUFFER WOULD PUSH THE SCREEN OUT OF CACHE BEFORE THE ENCODER
+		times.counts.add(context.counts);
+		times.covered += context.zbuffer.covered();
+
+		times.transform += seconds(t0, t1);
+		times.raster += raster;
+		times.resolve += resolve;
+		times.geometry += seconds(t1, t2) - raster - resolve;
+		times.to_string += seconds(t2, t3);
+		times.diff += seconds(t3, t4);
+		times.total += seconds(t0, t2) + seconds(t3, t4);
+		times.bytes += full.size();
+		times.diff_bytes += diff.size();
+	}
+
+	times.triangles = render_stats.triangles;
+	times.culled_cubes = render_stats.culled_cubes;
+	times.lod_cubes = render_stats.lod_cubes;
+	render_stats = RenderStats{};
+	return times;
+}
+
+// SOLVES count SEEDED RANDOM SCRAMBLES ONE AFTER ANOTHER ON THIS THREAD, REPORTING THE LENGTH AND LATENCY DISTRIBUTIONS
+static int bench_solver(int count, const SolveOptions& options) {
+	using Clock = std::chrono::steady_clock;
+	auto start = Clock::now();
+	if (!load_solver_tables(default_solver_cache_path())) {
+		std::cerr << "cannot load the solver tables\n";
+		return 1;
+	}
+	double load_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// 25 FACE TURNS, NO FACE TWICE IN A ROW, THE SAME SCRAMBLES EVERY RUN
+	const int scramble_length = 25;
+	std::mt19937 random(1);
+	std::uniform_int_distribution<> face(0, 5);
+	std::uniform_int_distribution<> power(0, 2);
+	std::vector<double> latencies;
+	std::vector<int> lengths;
+	int over = 0;
+	int invalid = 0;
+	double total = 0.0;
+	for (int i = 0; i < count; i++) {
+		CubeState state;
+		for (int n = 0, last = -1; n < scramble_length; n++) {
+			int f;
+			do f = face(random); while (f == last);
+			apply_move(state, f * 3 + power(random));
+			last = f;
+		}
+
+		auto t0 = Clock::now();
+		std::vector<int> solution = solve(state, options);
+		double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+		for (int move : solution) apply_move(state, move);
+		invalid += !is_solved(state);
+		over += (int)solution.size() > options.target_length;
+		latencies.push_back(seconds);
+		lengths.push_back((int)solution.size());
+		total += seconds;
+	}
+	std::sort(latencies.begin(), latencies.end());
+	std::sort(lengths.begin(), lengths.end());
+	auto at = [&](double p) {
+		return std::min(count - 1, (int)(p * count));
+	};
+	double length_sum = 0.0;
+	for (int length : lengths) length_sum += length;
+
+	std::printf("solver: %d scrambles of %d moves, target %d, timeout %.1f ms, tables %.1f ms, %d invalid\n", count, scramble_length,
+			options.target_length, options.timeout_seconds * 1000.0, load_seconds * 1000.0, invalid);
+	std::printf("length: mean %.2f p50 %d p90 %d max %d, %.1f%% over the target\n",
+			length_sum / count, lengths[at(0.50)], lengths[at(0.90)], lengths[count - 1], 100.0 * over / count);
+	std::printf("latency ms: mean %.3f p50 %.3f p90 %.3f p99 %.3f max %.3f, %.0f cubes/s\n", total / count * 1000.0,
+			latencies[at(0.50)] * 1000.0, latencies[at(0.90)] * 1000.0, latencies[at(0.99)] * 1000.0, latencies[count - 1] * 1000.0,
+			count / total);
+	return invalid == 0 ? 0 : 1;
+}
+
+int run_bench(int argc, char** argv) {
+	int frames = 600;
+	int threads = 1;
+	bool still = false;
+	bool wall_mode = false;
+	int wall_count = 0;
+	bool solver_mode = false;
+	int solver_count = 0;
+	SolveOptions solve_options;
+	OutputMode mode = OutputMode::Ansi16;
+	CellMode cell_mode = CellMode::Full;
+	std::vector<BenchSize> sizes;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			frames = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--still") == 0) {
+			still = true;
+		} else if (std::strcmp(argv[i], "--hiz") == 0) {
+			set_depth_rejection(true);
+		} else if (std::strcmp(argv[i], "--wall") == 0 && i + 1 < argc) {
+			wall_mode = true;
+			wall_count = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--solver") == 0 && i + 1 < argc) {
+			solver_mode = true;
+			solver_count = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+			solve_options.target_length = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+			solve_options.timeout_seconds = std::atof(argv[++i]);
+		} else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			if (!parse_output_mode(name, mode)) {
+				std::cerr << "unknown --output " << name << " (expected ftxui, ansi16, ansi256, truecolor or ppm)\n";
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--subcell") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			if (!parse_cell_mode(name, cell_mode)) {
+				std::cerr << "unknown --subcell " << name << " (expected full, half or quad)\n";
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--raster") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			bool found = false;
+			for (RasterPath path : {RasterPath::Scalar, RasterPath::SSE2, RasterPath::AVX2}) {
+				if (std::strcmp(name, raster_path_name(path)) == 0) {
+					found = true;
+					if (!set_raster_path(path)) {
+						std::cerr << "raster path " << name << " is not supported on this cpu\n";
+						return 1;
+					}
+				}
+			}
+			if (!found) {
+				std::cerr << "unknown --raster " << name << " (expected scalar, sse2 or avx2)\n";
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+			BenchSize size;
+			if (std::sscanf(argv[++i], "%dx%d", &size.width, &size.height) != 2 || size.width <= 0 || size.height <= 0) {
+				std::cerr << "invalid --size " << argv[i] << " (expected WxH)\n";
+				return 1;
+			}
+			sizes.push_back(size);
+		}
+	}
+	if (frames <= 0) {
+		std::cerr << "--frames must be positive\n";
+		return 1;
+	}
+	if (threads <= 0) {
+		std::cerr << "--threads must be positive\n";
+		return 1;
+	}
+	if (solver_mode) {
+		if (solver_count <= 0) {
+			std::cerr << "--solver must be positive\n";
+			return 1;
+		}
+		if (CUBE_N != 3) {
+			std::cerr << "--solver needs a 3x3 build (CUBE_SIZE=3)\n";
+			return 1;
+		}
+		if (solve_options.timeout_seconds < 0.0) {
+			std::cerr << "--timeout must not be negative\n";
+			return 1;
+		}
+		return bench_solver(solver_count, solve_options);
+	}
+	// THE WALL STARTS FROM THE SAME SEEDED SCRAMBLES EVERY RUN AND PLAYS THEM BACKWARDS (NO SOLVER TABLES NEEDED)
+	CubeWall wall;
+	if (wall_mode) {
+		std::string error;
+		if (!wall.setup(wall_count, "", false, 1, error)) {
+			std::cerr << error << "\n";
+			return 1;
+		}
+	}
+	if (sizes.empty()) {
+		sizes = {{80, 24}, {160, 48}, {240, 72}, {400, 120}};
+	}
+
+	std::printf("cube: %dx%dx%d, raster path: %s, hi-z: %s, threads: %d, camera: %s, output: %s, subcell: %s, cubes: %d\n", CUBE_N, CUBE_N, CUBE_N,
+			raster_path_name(raster_path()), depth_rejection() ? "on" : "off", threads, still ? "still" : "sweep", output_mode_name(mode),
+			cell_mode_name(cell_mode), std::max(1, wall_count));
+
+	// ALL STAGE TIMES ARE AVERAGE MILLISECONDS PER FRAME, frame/fps COUNT THE SELECTED ENCODER (NOT ToString)
+	std::printf("%-9s %8s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+			"size", "frames", "fps", "transform", "geometry", "raster", "tostring", "diff", "frame", "tris", "kB/full", "kB/diff");
+	for (const BenchSize& size : sizes) {
+		BenchTimes t = bench_size(size, frames, threads, still, mode, cell_mode, wall);
+		double ms = 1000.0 / frames;
+		std::printf("%4dx%-4d %8d %10.1f %10.4f %10.4f %10.4f %10.4f %10.4f %10.4f %10.1f %10.1f %10.2f\n",
+				size.width, size.height, frames,
+				frames / t.total,
+				t.transform * ms, t.geometry * ms, t.raster * ms, t.to_string * ms, t.diff * ms, t.total * ms,
+				(double)t.triangles / frames,
+				t.bytes / 1024.0 / frames,
+				t.diff_bytes / 1024.0 / frames);
+		std::printf("%9s overdraw %.2f (cells written per cell covered), hi-z rejected %.1f of %.1f triangles per frame\n", "",
+				t.covered > 0 ? (double)t.counts.cells / t.covered : 0.0,
+				(double)t.counts.rejected / frames, (double)t.counts.triangles / frames);
+		if (cell_mode != CellMode::Full) {
+			std::printf("%9s %d samples per cell, resolved into cells in %.4f ms per frame (not part of geometry or raster)\n", "",
+					cell_columns(cell_mode) * cell_rows(cell_mode), t.resolve * ms);
+		}
+		if (wall_mode) {
+			std::printf("%9s cubes per frame: %.1f culled, %.1f at low detail\n", "",
+					(double)t.culled_cubes / frames, (double)t.lod_cubes / frames);
+		}
+	}
+	return 0;
+}
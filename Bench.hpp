@@ -0,0 +1,7 @@
+#pragma once
+
+// HEADLESS BENCHMARK: RENDERS A SCRIPTED CAMERA SWEEP AND MOVE SEQUENCE INTO OFFSCREEN SCREENS
+// USAGE: RubiksRays --bench [--frames N] [--size WxH]... [--raster scalar|sse2|avx2] [--threads N]
+//        [--output ftxui|ansi16|ansi256|truecolor|ppm] [--subcell full|half|quad] [--wall N]
+//        RubiksRays --bench --solver N [--target N] [--timeout SECONDS] SOLVES N SEEDED SCRAMBLES INSTEAD
+int run_bench(int argc, char** argv);
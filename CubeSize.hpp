@@ -0,0 +1,17 @@
+#pragma once
+
+// EDGE LENGTH OF THE CUBE IN CUBE UNITS, FIXED AT BUILD TIME (cmake -DCUBE_SIZE=N)
+#ifndef CUBE_SIZE
+#define CUBE_SIZE 3
+#endif
+
+constexpr int CUBE_N = CUBE_SIZE;
+static_assert(CUBE_N >= 2 && CUBE_N <= 7, "CUBE_SIZE must be between 2 and 7");
+
+// ONLY THE OUTER SHELL OF CUBE UNITS IS BUILT, THE INSIDE CAN NEVER BE SEEN
+constexpr int SHELL_UNITS = CUBE_N * CUBE_N * CUBE_N - (CUBE_N - 2) * (CUBE_N - 2) * (CUBE_N - 2);
+
+constexpr int STICKER_COUNT = 6 * CUBE_N * CUBE_N;
+
+// LAYERS A FACE CAN TURN WITHOUT TURNING THE WHOLE CUBE (THE OUTER ONE PLUS ALL BUT THE LAST INNER ONE)
+constexpr int TURN_DEPTHS = CUBE_N - 1;
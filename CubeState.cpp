@@ -0,0 +1,349 @@
+#include "CubeState.hpp"
+
+// STICKERS BELONGING TO EACH CORNER/EDGE SLOT, FIRST STICKER IS THE U/D (OR F/B) REFERENCE
+static constexpr uint8_t corner_facelet[8][3] = {
+	{ 8,  9, 20}, { 6, 18, 38}, { 0, 36, 47}, { 2, 45, 11}, // URF UFL ULB UBR
+	{29, 26, 15}, {27, 44, 24}, {33, 53, 42}, {35, 17, 51}, // DFR DLF DBL DRB
+};
+static constexpr uint8_t edge_facelet[12][2] = {
+	{ 5, 10}, { 7, 19}, { 3, 37}, { 1, 46}, // UR UF UL UB
+	{32, 16}, {28, 25}, {30, 43}, {34, 52}, // DR DF DL DB
+	{23, 12}, {21, 41}, {50, 39}, {48, 14}, // FR FL BL BR
+};
+static constexpr uint8_t corner_color[8][3] = {
+	{FACE_U, FACE_R, FACE_F}, {FACE_U, FACE_F, FACE_L}, {FACE_U, FACE_L, FACE_B}, {FACE_U, FACE_B, FACE_R},
+	{FACE_D, FACE_F, FACE_R}, {FACE_D, FACE_L, FACE_F}, {FACE_D, FACE_B, FACE_L}, {FACE_D, FACE_R, FACE_B},
+};
+static constexpr uint8_t edge_color[12][2] = {
+	{FACE_U, FACE_R}, {FACE_U, FACE_F}, {FACE_U, FACE_L}, {FACE_U, FACE_B},
+	{FACE_D, FACE_R}, {FACE_D, FACE_F}, {FACE_D, FACE_L}, {FACE_D, FACE_B},
+	{FACE_F, FACE_R}, {FACE_F, FACE_L}, {FACE_B, FACE_L}, {FACE_B, FACE_R},
+};
+
+namespace {
+struct Vec3i {
+	int x, y, z;
+	bool operator==(const Vec3i&) const = default;
+};
+}
+
+// GRID POSITION AND OUTWARD NORMAL OF A FACELET (x RIGHT, y UP, z FRONT)
+static constexpr void facelet_geometry(int f, Vec3i& pos, Vec3i& normal) {
+	int r = f % 9 / 3;
+	int c = f % 3;
+	switch (f / 9) {
+		case FACE_U: pos = {c - 1, 1, r - 1}; normal = {0, 1, 0}; break;
+		case FACE_R: pos = {1, 1 - r, 1 - c}; normal = {1, 0, 0}; break;
+		case FACE_F: pos = {c - 1, 1 - r, 1}; normal = {0, 0, 1}; break;
+		case FACE_D: pos = {c - 1, -1, 1 - r}; normal = {0, -1, 0}; break;
+		case FACE_L: pos = {-1, 1 - r, c - 1}; normal = {-1, 0, 0}; break;
+		default:     pos = {1 - c, 1 - r, -1}; normal = {0, 0, -1}; break;
+	}
+}
+
+// THE INVERSE OF facelet_geometry, -1 IF NO FACELET SITS THERE
+static constexpr int find_facelet(Vec3i pos, Vec3i normal) {
+	constexpr Vec3i face_normal[6] = {{0, 1, 0}, {1, 0, 0}, {0, 0, 1}, {0, -1, 0}, {-1, 0, 0}, {0, 0, -1}};
+	int face = 0;
+	while (face < 6 && !(face_normal[face] == normal)) face++;
+	if (face == 6 || normal.x * pos.x + normal.y * pos.y + normal.z * pos.z != 1) return -1;
+
+	int r = 0, c = 0;
+	switch (face) {
+		case FACE_U: r = pos.z + 1; c = pos.x + 1; break;
+		case FACE_R: r = 1 - pos.y; c = 1 - pos.z; break;
+		case FACE_F: r = 1 - pos.y; c = pos.x + 1; break;
+		case FACE_D: r = 1 - pos.z; c = pos.x + 1; break;
+		case FACE_L: r = 1 - pos.y; c = pos.z + 1; break;
+		default:     r = 1 - pos.y; c = 1 - pos.x; break;
+	}
+	if (r < 0 || r > 2 || c < 0 || c > 2) return -1;
+	return face * 9 + r * 3 + c;
+}
+
+int facelet_at(int x, int y, int z, int nx, int ny, int nz) {
+	return find_facelet({x, y, z}, {nx, ny, nz});
+}
+
+// CLOCKWISE QUARTER TURN SEEN FROM THE TIP OF axis: v' = a(a.v) - a x v
+static constexpr Vec3i rotate_quarter(Vec3i v, Vec3i a) {
+	int d = a.x * v.x + a.y * v.y + a.z * v.z;
+	Vec3i c = {a.y * v.z - a.z * v.y, a.z * v.x - a.x * v.z, a.x * v.y - a.y * v.x};
+	return {a.x * d - c.x, a.y * d - c.y, a.z * d - c.z};
+}
+
+static constexpr CubeState cubies_from_facelets(const Facelets& f) {
+	CubeState state;
+	for (int i = 0; i < 8; i++) {
+		int ori = 0;
+		while (f[corner_facelet[i][ori]] != FACE_U && f[corner_facelet[i][ori]] != FACE_D) ori++;
+		uint8_t col1 = f[corner_facelet[i][(ori + 1) % 3]];
+		uint8_t col2 = f[corner_facelet[i][(ori + 2) % 3]];
+		for (int j = 0; j < 8; j++) {
+			if (corner_color[j][1] == col1 && corner_color[j][2] == col2) {
+				state.cp[i] = j;
+				state.co[i] = ori;
+			}
+		}
+	}
+	for (int i = 0; i < 12; i++) {
+		uint8_t a = f[edge_facelet[i][0]];
+		uint8_t b = f[edge_facelet[i][1]];
+		for (int j = 0; j < 12; j++) {
+			if (edge_color[j][0] == a && edge_color[j][1] == b) {
+				state.ep[i] = j;
+				state.eo[i] = 0;
+			}
+			if (edge_color[j][0] == b && edge_color[j][1] == a) {
+				state.ep[i] = j;
+				state.eo[i] = 1;
+			}
+		}
+	}
+	for (int i = 0; i < 6; i++) state.centers[i] = f[i * 9 + 4];
+	return state;
+}
+
+CubeState from_facelets(const Facelets& f) {
+	return cubies_from_facelets(f);
+}
+
+static constexpr CubeState compose(const CubeState& a, const CubeState& b) {
+	CubeState r;
+	for (int i = 0; i < 8; i++) {
+		r.cp[i] = a.cp[b.cp[i]];
+		r.co[i] = (a.co[b.cp[i]] + b.co[i]) % 3;
+	}
+	for (int i = 0; i < 12; i++) {
+		r.ep[i] = a.ep[b.ep[i]];
+		r.eo[i] = a.eo[b.ep[i]] ^ b.eo[i];
+	}
+	for (int i = 0; i < 6; i++) r.centers[i] = a.centers[b.centers[i]];
+	return r;
+}
+
+CubeState multiply(const CubeState& a, const CubeState& b) {
+	return compose(a, b);
+}
+
+// GENERATES A MOVE BY TURNING THE STICKERS OF THE SOLVED CUBE IN 3D
+static constexpr CubeState generate_move(int move) {
+	// AXIS OF EACH FACE AND ROTATION (x FOLLOWS R, y FOLLOWS U, z FOLLOWS F)
+	constexpr Vec3i face_axis[6] = {{0, 1, 0}, {1, 0, 0}, {0, 0, 1}, {0, -1, 0}, {-1, 0, 0}, {0, 0, -1}};
+	constexpr Vec3i rotation_axis[3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+	bool whole_cube = move >= FACE_MOVE_COUNT;
+	Vec3i axis = whole_cube ? rotation_axis[(move - FACE_MOVE_COUNT) / 3] : face_axis[move / 3];
+	int turns = move % 3 + 1;
+
+	Facelets f{};
+	for (int i = 0; i < 54; i++) f[i] = i / 9;
+
+	for (int t = 0; t < turns; t++) {
+		Facelets turned = f;
+		for (int i = 0; i < 54; i++) {
+			Vec3i pos, normal;
+			facelet_geometry(i, pos, normal);
+			int layer = axis.x * pos.x + axis.y * pos.y + axis.z * pos.z;
+			if (!whole_cube && layer != 1) continue;
+			turned[find_facelet(rotate_quarter(pos, axis), rotate_quarter(normal, axis))] = f[i];
+		}
+		f = turned;
+	}
+	return cubies_from_facelets(f);
+}
+
+// EVERY MOVE AS THE STATE IT TURNS THE SOLVED CUBE INTO, READ ONLY DATA BUILT BY THE COMPILER
+static constexpr std::array<CubeState, MOVE_COUNT> move_states = [] {
+	std::array<CubeState, MOVE_COUNT> t;
+	for (int m = 0; m < MOVE_COUNT; m++) t[m] = generate_move(m);
+	return t;
+}();
+
+static constexpr bool moves_cancel_inverses() {
+	for (int m = 0; m < MOVE_COUNT; m++) {
+		if (compose(move_states[m], move_states[inverse_move(m)]) != CubeState()) return false;
+	}
+	return true;
+}
+static_assert(moves_cancel_inverses(), "a move followed by its inverse must leave the cube solved");
+
+// A QUARTER TURN IS NOT THE IDENTITY, TWO OF THEM ARE THE HALF TURN AND FOUR OF THEM ARE THE IDENTITY
+static constexpr bool quarter_turns_have_order_four() {
+	for (int m = 0; m < MOVE_COUNT; m += 3) {
+		CubeState half = compose(move_states[m], move_states[m]);
+		if (move_states[m] == CubeState() || half != move_states[m + 1] || compose(half, half) != CubeState()) return false;
+	}
+	return true;
+}
+static_assert(quarter_turns_have_order_four(), "every quarter turn must have order 4");
+
+const CubeState& move_table(int move) {
+	return move_states[move];
+}
+
+void apply_move(CubeState& state, int move) {
+	state = compose(state, move_states[move]);
+}
+
+int move_from_char(char c) {
+	static const char letters[] = "urfdlbxyz";
+	for (int i = 0; i < 9; i++) {
+		if (c == letters[i]) return i * 3;
+		if (c == letters[i] - 'a' + 'A') return i * 3 + 2;
+	}
+	return -1;
+}
+
+void append_move_chars(std::string& out, int move) {
+	static const char letters[] = "urfdlbxyz";
+	char c = letters[move / 3];
+	if (move % 3 == 0) out += c;
+	if (move % 3 == 1) out.append(2, c);
+	if (move % 3 == 2) out += (char)(c - 'a' + 'A');
+}
+
+// ORIENTATIONS IN THE ORDER A BREADTH FIRST SEARCH OVER THE ROTATION MOVES FINDS THEM, THE IDENTITY FIRST
+// (A 25TH ORIENTATION WOULD INDEX PAST THE END, WHICH STOPS THE COMPILE)
+static constexpr std::array<CubeState, ORIENTATION_COUNT> orientation_states = [] {
+	std::array<CubeState, ORIENTATION_COUNT> found;
+	int count = 1;
+	for (int i = 0; i < count; i++) {
+		for (int m = MOVE_X; m < MOVE_COUNT; m++) {
+			CubeState next = compose(found[i], move_states[m]);
+			bool known = false;
+			for (int j = 0; j < count; j++) known = known || found[j] == next;
+			if (!known) found[count++] = next;
+		}
+	}
+	return found;
+}();
+
+// A WHOLE CUBE ROTATION IS KNOWN FROM WHERE IT TAKES THE CENTERS ALONE
+static constexpr int orientation_index(const std::array<uint8_t, 6>& centers) {
+	for (int o = 0; o < ORIENTATION_COUNT; o++) {
+		if (orientation_states[o].centers == centers) return o;
+	}
+	return -1;
+}
+
+static constexpr bool orientations_distinct() {
+	for (int o = 0; o < ORIENTATION_COUNT; o++) {
+		if (orientation_index(orientation_states[o].centers) != o) return false;
+	}
+	return true;
+}
+static_assert(orientations_distinct(), "the rotation moves must reach exactly 24 orientations");
+
+// THE ROTATION GROUP OF THE CUBE AS LOOKUPS: HOW ORIENTATIONS COMBINE AND HOW A FACE MOVE MADE IN ONE OF THEM
+// MAPS BACK TO THE UNTURNED CUBE (THE 24 MIRRORED SYMMETRIES ARE LEFT OUT, NO MOVE SEQUENCE CAN REACH THEM)
+struct OrientationTables {
+	uint8_t product[ORIENTATION_COUNT][ORIENTATION_COUNT];
+	uint8_t inverse[ORIENTATION_COUNT];
+	uint8_t rotation[MOVE_COUNT - MOVE_X];
+	uint8_t conjugate[ORIENTATION_COUNT][FACE_MOVE_COUNT];
+	char letters[ORIENTATION_COUNT][4];
+};
+
+static constexpr OrientationTables orientation_tables = [] {
+	OrientationTables t{};
+	for (int o = 0; o < ORIENTATION_COUNT; o++) {
+		for (int p = 0; p < ORIENTATION_COUNT; p++) {
+			std::array<uint8_t, 6> centers{};
+			for (int i = 0; i < 6; i++) centers[i] = orientation_states[o].centers[orientation_states[p].centers[i]];
+			t.product[o][p] = (uint8_t)orientation_index(centers);
+			if (t.product[o][p] == 0) t.inverse[o] = (uint8_t)p;
+		}
+	}
+	for (int m = MOVE_X; m < MOVE_COUNT; m++) t.rotation[m - MOVE_X] = (uint8_t)orientation_index(move_states[m].centers);
+
+	// A FACE MOVE m AFTER ROTATION q IS THE FACE MOVE q m q' DONE BEFORE q, A ROTATION KEEPS THE DIRECTION OF A TURN
+	// SO ONLY THE QUARTER TURNS ARE SEARCHED
+	for (int o = 0; o < ORIENTATION_COUNT; o++) {
+		for (int m = 0; m < FACE_MOVE_COUNT; m += 3) {
+			CubeState conjugate = compose(compose(orientation_states[o], move_states[m]), orientation_states[t.inverse[o]]);
+			int found = 0xff;
+			for (int f = 0; f < FACE_MOVE_COUNT; f += 3) {
+				if (move_states[f] == conjugate) found = f;
+			}
+			for (int power = 0; power < 3; power++) t.conjugate[o][m + power] = (uint8_t)(found + power);
+		}
+	}
+
+	// BREADTH FIRST OVER QUARTER ROTATIONS FROM THE STARTING ORIENTATION (NEVER MORE THAN THREE LETTERS, A FOURTH
+	// WOULD PUT THE TERMINATOR PAST THE END OF letters AND STOP THE COMPILE)
+	constexpr char rotation_letters[] = "xXyYzZ";
+	int queue[ORIENTATION_COUNT] = {0};
+	bool seen[ORIENTATION_COUNT] = {true};
+	int queued = 1;
+	for (int i = 0; i < queued; i++) {
+		int o = queue[i];
+		for (int r = 0; r < 6; r++) {
+			int next = t.product[o][t.rotation[r / 2 * 3 + r % 2 * 2]];
+			if (seen[next]) continue;
+			seen[next] = true;
+			int length = 0;
+			while (t.letters[o][length]) {
+				t.letters[next][length] = t.letters[o][length];
+				length++;
+			}
+			t.letters[next][length] = rotation_letters[r];
+			t.letters[next][length + 1] = 0;
+			queue[queued++] = next;
+		}
+	}
+	return t;
+}();
+
+static constexpr bool conjugates_are_face_moves() {
+	for (int o = 0; o < ORIENTATION_COUNT; o++) {
+		for (int m = 0; m < FACE_MOVE_COUNT; m++) {
+			if (orientation_tables.conjugate[o][m] >= FACE_MOVE_COUNT) return false;
+		}
+	}
+	return true;
+}
+static_assert(conjugates_are_face_moves(), "a quarter turn made in any orientation must be a quarter turn of the unturned cube");
+
+const std::array<CubeState, ORIENTATION_COUNT>& orientations() {
+	return orientation_states;
+}
+
+int orientation_product(int o, int p) {
+	return orientation_tables.product[o][p];
+}
+
+int rotation_orientation(int move) {
+	return orientation_tables.rotation[move - MOVE_X];
+}
+
+int conjugate_move(int o, int move) {
+	return orientation_tables.conjugate[o][move];
+}
+
+const char* orientation_letters(int o) {
+	return orientation_tables.letters[o];
+}
+
+bool is_solved(const CubeState& state) {
+	Facelets f = to_facelets(state);
+	for (int i = 0; i < 54; i++) {
+		if (f[i] != f[i / 9 * 9 + 4]) return false;
+	}
+	return true;
+}
+
+Facelets to_facelets(const CubeState& state) {
+	Facelets f;
+	for (int i = 0; i < 8; i++) {
+		for (int n = 0; n < 3; n++) {
+			f[corner_facelet[i][(n + state.co[i]) % 3]] = corner_color[state.cp[i]][n];
+		}
+	}
+	for (int i = 0; i < 12; i++) {
+		for (int n = 0; n < 2; n++) {
+			f[edge_facelet[i][(n + state.eo[i]) % 2]] = edge_color[state.ep[i]][n];
+		}
+	}
+	for (int i = 0; i < 6; i++) f[i * 9 + 4] = state.centers[i];
+	return f;
+}
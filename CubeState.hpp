@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// FACES IN SOLVER ORDER, ALSO USED AS STICKER COLOR INDICES
+enum Face : uint8_t { FACE_U, FACE_R, FACE_F, FACE_D, FACE_L, FACE_B };
+
+// MOVE INDICES: FACE TURNS ARE face * 3 + power (POWER 0 = CLOCKWISE, 1 = HALF, 2 = COUNTER CLOCKWISE)
+// FOLLOWED BY THE WHOLE CUBE ROTATIONS x, y, z IN THE SAME LAYOUT
+constexpr int FACE_MOVE_COUNT = 18;
+constexpr int MOVE_COUNT = 27;
+constexpr int MOVE_X = 18;
+constexpr int MOVE_Y = 21;
+constexpr int MOVE_Z = 24;
+
+// LOGICAL CUBE STATE (CORNER/EDGE PERMUTATION AND ORIENTATION PLUS CENTERS FOR ROTATIONS)
+// cp[i] IS THE CORNER CUBIE SITTING IN CORNER SLOT i, co[i] ITS TWIST (0..2), LIKEWISE FOR EDGES
+// centers[i] IS THE CENTER (ORIGINAL FACE) CURRENTLY ON FACE i
+struct CubeState {
+	std::array<uint8_t, 8> cp = {0, 1, 2, 3, 4, 5, 6, 7};
+	std::array<uint8_t, 8> co = {};
+	std::array<uint8_t, 12> ep = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+	std::array<uint8_t, 12> eo = {};
+	std::array<uint8_t, 6> centers = {0, 1, 2, 3, 4, 5};
+
+	bool operator==(const CubeState&) const = default;
+};
+
+// STICKER COLORS IN FACELET ORDER (U1..U9, R1..R9, F1..F9, D1..D9, L1..L9, B1..B9)
+using Facelets = std::array<uint8_t, 54>;
+
+// COMPOSES TWO STATES (APPLY a THEN b)
+CubeState multiply(const CubeState& a, const CubeState& b);
+
+// APPLIES A SINGLE MOVE USING THE MOVE TABLE (GENERATED AT COMPILE TIME)
+void apply_move(CubeState& state, int move);
+
+// RETURNS THE STATE REACHED BY APPLYING move TO THE SOLVED CUBE
+const CubeState& move_table(int move);
+
+// INVERSE OF A MOVE INDEX (U <-> U', U2 <-> U2)
+constexpr int inverse_move(int move) {
+	return move - move % 3 + (2 - move % 3);
+}
+
+// MAPS MOVE LIST LETTERS (udrlfbxyz CLOCKWISE, UPPERCASE COUNTER CLOCKWISE) TO MOVE INDICES, -1 IF NOT A MOVE
+int move_from_char(char c);
+
+// APPENDS THE MOVE LIST LETTERS FOR A MOVE INDEX (A HALF TURN IS TWO CLOCKWISE LETTERS)
+void append_move_chars(std::string& out, int move);
+
+constexpr int ORIENTATION_COUNT = 24;
+
+// THE 24 WHOLE CUBE ORIENTATIONS (SOLVED CUBE TURNED BY x/y/z ROTATIONS), THE FIRST ONE IS THE IDENTITY
+const std::array<CubeState, ORIENTATION_COUNT>& orientations();
+
+// ORIENTATION o TURNED FURTHER BY ORIENTATION p, THE INDEX OF multiply(orientations()[o], orientations()[p])
+int orientation_product(int o, int p);
+
+// ORIENTATION THE ROTATION MOVE move (MOVE_X AND UP) TURNS THE SOLVED CUBE TO
+int rotation_orientation(int move);
+
+// FACE MOVE move MADE WITH THE CUBE TURNED TO ORIENTATION o, AS THE FACE MOVE OF THE UNTURNED CUBE WITH THE SAME EFFECT
+int conjugate_move(int o, int move);
+
+// SHORTEST QUARTER ROTATION LETTERS (x X y Y z Z) THAT REACH ORIENTATION o FROM THE FIRST ONE
+const char* orientation_letters(int o);
+
+// TRUE IF EVERY FACE SHOWS A SINGLE COLOR (ANY WHOLE CUBE ORIENTATION)
+bool is_solved(const CubeState& state);
+
+// EXPANDS CUBIES TO STICKER COLORS
+Facelets to_facelets(const CubeState& state);
+
+// BUILDS CUBIES BACK FROM STICKER COLORS
+CubeState from_facelets(const Facelets& facelets);
+
+// FACELET INDEX OF THE STICKER AT GRID POSITION (x, y, z) IN {-1, 0, 1} FACING ALONG normal, -1 IF NONE
+int facelet_at(int x, int y, int z, int nx, int ny, int nz);
@@ -1,8 +1,15 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "Framebuffer.hpp"
+#include <glm/glm.hpp>
+#include "CubeSize.hpp"
+
 struct Triangle {
 	glm::vec3 points[3];
-	ftxui::Color color;
+	uint8_t color;
 };
 
 struct Plane {
@@ -12,12 +19,67 @@ struct Plane {
 	glm::mat4 rotation;
 };
 
+struct Vec3i {
+	int x, y, z;
+};
+
+// POSE OF ONE CUBE UNIT IN CUBE SPACE, ITS GEOMETRY LIVES IN THE SHARED CubeMesh
+// THE RESTING POSE IS EXACT: A GRID SLOT AND ONE OF THE 24 ORIENTATIONS OF THE CUBE, ONLY CHANGED WHEN A TURN LANDS
+// A TURN IN FLIGHT ADDS angle ABOUT THE TURN AXIS, EVALUATED FROM THE TURN PROGRESS (NEVER ACCUMULATED)
 struct CubeUnit {
-	Plane plane[6];
+	Vec3i grid;
+	uint8_t orientation = 0;
+	float angle = 0.0f;
+
+	// WHAT THE RENDERER DRAWS, DERIVED FROM THE ABOVE EVERY STEP THE UNIT MOVES
 	glm::vec3 position;
 	glm::mat4 rotation;
 };
 
+// EVERY TRIANGLE OF THE CUBE COMPILED ONCE INTO FLAT ARRAYS (STRUCTURE OF ARRAYS), SHARED BY EVERY Cube
+// VERTEX POSITIONS ARE IN CUBE UNIT SPACE, SO ONE MODEL MATRIX PER CUBE UNIT PLACES THEM IN THE WORLD
+// FACE f = UNIT * 6 + PLANE OWNS VERTICES f * 6 .. f * 6 + 5 (TWO TRIANGLES)
+constexpr int16_t HOLLOW_NEIGHBOUR = -2;
+
+struct CubeMesh {
+	std::vector<float> x, y, z;
+
+	// PER FACE, IN CUBE UNIT SPACE
+	std::array<glm::vec3, SHELL_UNITS * 6> face_normal;
+	std::array<glm::vec3, SHELL_UNITS * 6> face_center;
+
+	// CUBE UNIT ON THE OTHER SIDE OF AN INTERIOR FACE, -1 FOR FACES ON THE OUTSIDE OF THE CUBE, HOLLOW_NEIGHBOUR
+	// FOR FACES TURNED TO THE (NEVER BUILT) INSIDE OF THE SHELL
+	std::array<int16_t, SHELL_UNITS * 6> face_neighbour;
+
+	// BITMASK OF CUBE SIDES (AXIS * 2 + POSITIVE) WHOSE GRID LINES SHOW THE GAP IN FRONT OF AN INTERIOR FACE
+	std::array<uint8_t, SHELL_UNITS * 6> face_gap_sides;
+
+	// STICKER SHOWN ON EACH FACE (-1 FOR THE BLACK INSIDE FACES)
+	std::array<int16_t, SHELL_UNITS * 6> face_sticker;
+
+	// LEVEL OF DETAIL FOR CUBES ONLY A FEW CELLS ACROSS: ONE QUAD PER SIDE OF THE WHOLE CUBE (IN CUBE SPACE, SIDES
+	// IN PLANE ORDER, 6 VERTICES EACH) PAINTED WITH THE MOST COMMON COLOR OF THE STICKER FACES ON THAT SIDE
+	std::vector<float> side_x, side_y, side_z;
+	std::array<std::array<int16_t, CUBE_N * CUBE_N>, 6> side_faces;
+
+	// DISTANCE FROM THE CENTER OF THE CUBE TO ITS SIDES
+	float extent = 0.0f;
+};
+
+// ONE CUBE: THE POSE OF EACH UNIT, THE COLOR OF EACH FACE AND WHERE THE CUBE SITS IN THE WORLD
 struct Cube {
-	CubeUnit units[27];
+	CubeUnit units[SHELL_UNITS];
+
+	// COLOR OF EACH FACE OF THE SHARED MESH, REPAINTED FROM THE STICKERS BY sync_cube
+	std::array<uint8_t, SHELL_UNITS * 6> face_color;
+
+	// CUBE SPACE TO WORLD, IDENTITY FOR THE SINGLE CUBE OF THE INTERACTIVE MODE
+	glm::mat4 model = glm::mat4(1.0f);
+
+	// UNITS A TURN ANIMATION IS MOVING (SET BY start_transform, CLEARED BY sync_cube)
+	std::array<uint8_t, SHELL_UNITS> moving = {};
+
+	// BUMPED BY sync_cube, THE ONLY PLACE UNITS THAT ARE NOT MOVING CHANGE POSE OR COLOR
+	uint32_t revision = 0;
 };
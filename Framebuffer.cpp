@@ -0,0 +1,50 @@
+#include <algorithm>
+#include "Framebuffer.hpp"
+
+void Framebuffer::resize(int w, int h) {
+	if (w == width && h == height) return;
+	width = w;
+	height = h;
+	cells.assign((size_t)w * h, Cell());
+}
+
+void Framebuffer::clear() {
+	std::fill(cells.begin(), cells.end(), Cell());
+}
+
+void Framebuffer::print(int x, int y, const char* text, uint8_t color, bool bold) {
+	if (y < 0 || y >= height) return;
+	Cell* cells_row = row(y);
+	for (int i = 0; text[i] != '\0' && x + i < width; i++) {
+		if (x + i < 0) continue;
+		cells_row[x + i] = {text[i], color, (uint8_t)bold};
+	}
+}
+
+const char* quadrant_utf8(uint8_t quadrants) {
+	static const char* const glyphs[16] = {
+		" ", "\u2598", "\u259d", "\u2580", "\u2596", "\u258c", "\u259e", "\u259b",
+		"\u2597", "\u259a", "\u2590", "\u259c", "\u2584", "\u2599", "\u259f", "\u2588",
+	};
+	return glyphs[quadrants & GLYPH_QUADRANTS];
+}
+
+Rgb palette_rgb(uint8_t color) {
+	// NAMED COLORS
+	static const Rgb named[16] = {
+		{0, 0, 0}, {205, 0, 0}, {0, 205, 0}, {205, 205, 0}, {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+		{127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0}, {92, 92, 255}, {255, 0, 255}, {0, 255, 255}, {255, 255, 255},
+	};
+	if (color < 16) return named[color];
+
+	// 6x6x6 COLOR CUBE
+	if (color < 232) {
+		static const uint8_t level[6] = {0, 95, 135, 175, 215, 255};
+		int c = color - 16;
+		return {level[c / 36], level[c / 6 % 6], level[c % 6]};
+	}
+
+	// GRAYSCALE RAMP
+	uint8_t gray = (uint8_t)(8 + (color - 232) * 10);
+	return {gray, gray, gray};
+}
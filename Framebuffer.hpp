@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CELL COLORS ARE INDICES INTO THE XTERM 256 COLOR PALETTE, THE FIRST 16 ARE THE NAMED ANSI COLORS
+enum CellColor : uint8_t {
+	COLOR_BLACK = 0,
+	COLOR_RED = 1,
+	COLOR_GREEN = 2,
+	COLOR_YELLOW = 3,
+	COLOR_BLUE = 4,
+	COLOR_MAGENTA = 5,
+	COLOR_CYAN = 6,
+	COLOR_GRAY_LIGHT = 7,
+	COLOR_GRAY_DARK = 8,
+	COLOR_RED_LIGHT = 9,
+	COLOR_GREEN_LIGHT = 10,
+	COLOR_YELLOW_LIGHT = 11,
+	COLOR_BLUE_LIGHT = 12,
+	COLOR_MAGENTA_LIGHT = 13,
+	COLOR_CYAN_LIGHT = 14,
+	COLOR_WHITE = 15,
+};
+
+// SUB-CELL GLYPHS ARE THE CONTROL CODES 1 .. 31: BITS 0-3 ARE THE QUADRANTS (TOP LEFT, TOP RIGHT, BOTTOM LEFT,
+// BOTTOM RIGHT) DRAWN IN color, THE OTHER QUADRANTS SHOW background WHEN GLYPH_BACKGROUND IS SET, OTHERWISE THE
+// TERMINAL BACKGROUND (TOP HALF 3, BOTTOM HALF 12 AND FULL BLOCK 15 ARE ALL A HALF BLOCK CELL NEEDS)
+constexpr uint8_t GLYPH_QUADRANTS = 0x0f;
+constexpr uint8_t GLYPH_BACKGROUND = 0x10;
+
+// ONE TERMINAL CELL PACKED INTO 4 BYTES, THE BACKGROUND IS THE TERMINAL DEFAULT EXCEPT BEHIND A SUB-CELL GLYPH
+// A BLANK (' ') CELL ONLY SHOWS THE BACKGROUND, ITS COLOR AND BOLD ARE IGNORED
+struct Cell {
+	char glyph = ' ';
+	uint8_t color = COLOR_WHITE;
+	uint8_t bold = 0;
+	uint8_t background = 0;
+
+	bool operator==(const Cell&) const = default;
+};
+
+inline bool block_glyph(const Cell& cell) {
+	return (uint8_t)cell.glyph >= 1 && (uint8_t)cell.glyph < 0x20;
+}
+
+// PALETTE INDEX BEHIND THE CELL, -1 FOR THE TERMINAL DEFAULT
+inline int background_color(const Cell& cell) {
+	return block_glyph(cell) && (cell.glyph & GLYPH_BACKGROUND) ? cell.background : -1;
+}
+
+// UTF-8 BLOCK ELEMENT SHOWING quadrants (GLYPH_QUADRANTS BITS, 0 IS A SPACE)
+const char* quadrant_utf8(uint8_t quadrants);
+
+// ROW MAJOR GRID OF CELLS EVERYTHING IS DRAWN INTO, OUTPUT BACKENDS TURN IT INTO TERMINAL BYTES OR IMAGES
+struct Framebuffer {
+	int width = 0;
+	int height = 0;
+	std::vector<Cell> cells;
+
+	// ONLY REALLOCATES WHEN THE SIZE CHANGES, CONTENTS ARE UNSPECIFIED AFTERWARDS
+	void resize(int w, int h);
+
+	// EVERY CELL BLANK
+	void clear();
+
+	Cell& at(int x, int y) { return cells[(size_t)y * width + x]; }
+	const Cell& at(int x, int y) const { return cells[(size_t)y * width + x]; }
+	Cell* row(int y) { return &cells[(size_t)y * width]; }
+	const Cell* row(int y) const { return &cells[(size_t)y * width]; }
+
+	// WRITES text FROM (x, y) TO THE RIGHT, CLIPPED TO THE BUFFER
+	void print(int x, int y, const char* text, uint8_t color, bool bold);
+};
+
+// 8 BIT RGB OF A PALETTE INDEX (STANDARD XTERM VALUES)
+struct Rgb {
+	uint8_t r, g, b;
+};
+Rgb palette_rgb(uint8_t color);
@@ -0,0 +1,92 @@
+#include "CubeState.hpp"
+#include "MoveHistory.hpp"
+
+// ORIENTATION OF THE SOLVED CUBE TURNED quarters ABOUT axis (U/D, R/L, F/B)
+static int axis_rotation(int axis, int quarters) {
+	static const int rotation_axis[3] = {1, 0, 2}; // y, x, z
+	return rotation_orientation(MOVE_X + rotation_axis[axis] * 3 + quarters - 1);
+}
+
+// TURN AS A MOVE, INNER LAYERS ARE NAMED FROM THE NEARER FACE (THE MIDDLE ONE FROM U, R OR F)
+static Move turn_move(const MoveHistory::Turn& turn) {
+	if (2 * turn.layer <= CUBE_N - 1) return {turn.axis, (int8_t)turn.layer, turn.quarters};
+	return {(uint8_t)(turn.axis + 3), (int8_t)(CUBE_N - 1 - turn.layer), (uint8_t)(4 - turn.quarters)};
+}
+
+static size_t letter_count(const MoveHistory::Turn& turn) {
+	Move move = turn_move(turn);
+	return (move.quarters == 2 ? 2 : 1) * (move.depth > 0 ? 2 : 1);
+}
+
+void MoveHistory::push(const Move& move) {
+	if (move.depth == WHOLE_CUBE) {
+		bool positive = move.face < 3;
+		orientation = (uint8_t)orientation_product(orientation, axis_rotation(move.face % 3, positive ? move.quarters : 4 - move.quarters));
+		letters.resize(turn_letters);
+		letters += orientation_letters(orientation);
+		return;
+	}
+
+	int face = conjugate_move(orientation, move.face * 3) / 3;
+	bool positive = face < 3;
+	push_turn(Turn{
+		(uint8_t)(face % 3),
+		(uint8_t)(positive ? move.depth : CUBE_N - 1 - move.depth),
+		(uint8_t)(positive ? move.quarters : 4 - move.quarters),
+	});
+}
+
+void MoveHistory::push_move(int move) {
+	push(move_from_index(move));
+}
+
+void MoveHistory::clear() {
+	turns.clear();
+	orientation = 0;
+	letters.clear();
+	turn_letters = 0;
+}
+
+// ONLY THE TRAILING RUN OF TURNS ON THE NEW TURN'S AXIS CAN CHANGE, AND IT HOLDS AT MOST ONE TURN PER LAYER (CUBE_N)
+// SO THE SCANS, THE erase/insert (WHICH ONLY SHIFT TURNS OF THAT RUN) AND THE LETTER REWRITE ARE ALL O(CUBE_N)
+// ABSORBING THE RUN INTO A ROTATION CANNOT MERGE ANYTHING FURTHER BACK, THE RUN BEFORE IT IS ON ANOTHER AXIS
+void MoveHistory::push_turn(Turn turn) {
+	size_t first = turns.size();
+	size_t first_letter = turn_letters;
+	while (first > 0 && turns[first - 1].axis == turn.axis) {
+		first--;
+		first_letter -= letter_count(turns[first]);
+	}
+
+	// MERGE WITH THE SAME LAYER, OR INSERT IN LAYER ORDER
+	size_t at = first;
+	while (at < turns.size() && turns[at].layer < turn.layer) at++;
+	if (at < turns.size() && turns[at].layer == turn.layer) {
+		turns[at].quarters = (uint8_t)((turns[at].quarters + turn.quarters) % 4);
+		if (turns[at].quarters == 0) turns.erase(turns.begin() + at);
+	} else {
+		turns.insert(turns.begin() + at, turn);
+	}
+
+	// EVERY LAYER TURNED THE SAME WAY IS A ROTATION DONE BEFORE THE CURRENT ONE
+	bool whole_cube = turns.size() - first == CUBE_N;
+	for (size_t i = first; whole_cube && i < turns.size(); i++) {
+		whole_cube = turns[i].quarters == turns[first].quarters;
+	}
+	if (whole_cube) {
+		orientation = (uint8_t)orientation_product(axis_rotation(turn.axis, turns[first].quarters), orientation);
+		turns.resize(first);
+	}
+
+	rewrite_from(first, first_letter);
+}
+
+// REWRITES THE LETTERS OF turns[first..] (WHICH START AT first_letter) AND THE ROTATION SUFFIX
+void MoveHistory::rewrite_from(size_t first, size_t first_letter) {
+	letters.resize(first_letter);
+	for (size_t i = first; i < turns.size(); i++) {
+		append_move(letters, turn_move(turns[i]));
+	}
+	turn_letters = letters.size();
+	letters += orientation_letters(orientation);
+}
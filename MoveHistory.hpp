@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Stickers.hpp"
+
+// MOVE HISTORY KEPT IN CANONICAL FORM AS MOVES ARE APPENDED, EACH APPEND ONLY TOUCHES THE TRAILING RUN ON ONE AXIS,
+// WHICH HOLDS AT MOST CUBE_N TURNS (ONE PER LAYER), SO AN APPEND IS O(CUBE_N) WORST CASE, CONSTANT FOR A GIVEN CUBE SIZE
+// (NOT AMORTIZED, THE HISTORY BEFORE THAT RUN IS NEVER LOOKED AT):
+// - WHOLE CUBE ROTATIONS ARE ABSORBED, LATER TURNS ARE RELABELED TO THE FACE THEY TURN IN THE STARTING
+//   ORIENTATION AND THE NET ROTATION IS KEPT ON ITS OWN (WRITTEN AS THE SHORTEST x/y/z LETTERS AT THE END)
+// - TURNS OF ONE LAYER MERGE (u u IS A HALF TURN, u U CANCELS)
+// - TURNS ON ONE AXIS COMMUTE, SO A RUN ON ONE AXIS HOLDS AT MOST ONE TURN PER LAYER, IN LAYER ORDER (U BEFORE D),
+//   AND A RUN TURNING EVERY LAYER THE SAME WAY BECOMES A ROTATION
+struct MoveHistory {
+	// A TURN OF LAYER layer (0 = U, R OR F SIDE) ABOUT AXIS axis (U/D, R/L OR F/B), CLOCKWISE SEEN FROM U, R OR F
+	struct Turn {
+		uint8_t axis;
+		uint8_t layer;
+		uint8_t quarters; // 1..3
+	};
+
+	std::vector<Turn> turns;
+	uint8_t orientation = 0; // INDEX INTO orientations()
+
+	// THE WHOLE HISTORY IN MOVE LIST NOTATION (SEE append_move), ROTATION LETTERS LAST
+	std::string letters;
+
+	void push(const Move& move);
+
+	// MOVE INDEX AS IN CubeState.hpp
+	void push_move(int move);
+
+	void clear();
+
+	// LETTERS BEFORE THE ROTATION SUFFIX
+	size_t turn_letters = 0;
+
+	void push_turn(Turn turn);
+	void rewrite_from(size_t first, size_t first_letter);
+};
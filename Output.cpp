@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include "Output.hpp"
+#include "Profile.hpp"
+
+// APPENDS A NUMBER WITHOUT GOING THROUGH std::to_string
+static void append_int(std::string& out, int value) {
+	char digits[12];
+	int n = std::snprintf(digits, sizeof(digits), "%d", value);
+	out.append(digits, n);
+}
+
+// BLANK CELLS ONLY SHOW THEIR BACKGROUND, LEFTOVER FOREGROUND/BOLD DOES NOT MAKE THEM DIFFERENT
+static bool same_cell(const ftxui::Pixel& a, const ftxui::Pixel& b) {
+	if (a.character == " " && b.character == " ") {
+		return a.background_color == b.background_color;
+	}
+	return a.character == b.character
+		&& a.foreground_color == b.foreground_color
+		&& a.background_color == b.background_color
+		&& a.bold == b.bold;
+}
+
+void TerminalOutput::invalidate() {
+	width = 0;
+	height = 0;
+}
+
+const std::string& TerminalOutput::encode(const ftxui::Screen& screen) {
+	buffer.clear();
+
+	// SIZE CHANGE (OR INVALIDATE) MEANS A FULL REDRAW FROM A KNOWN PEN STATE
+	bool redraw = screen.dimx() != width || screen.dimy() != height;
+	if (redraw) {
+		width = screen.dimx();
+		height = screen.dimy();
+		previous.assign((size_t)width * height, ftxui::Pixel());
+		foreground = ftxui::Color::Default;
+		background = ftxui::Color::Default;
+		bold = false;
+		buffer += "\033[0m\033[2J\033[?25l";
+	}
+
+	// -1 WHEN THE CURSOR POSITION IS UNKNOWN (START OF FRAME OR PENDING WRAP AT THE RIGHT EDGE)
+	int cursor_x = -1;
+	int cursor_y = -1;
+
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			const ftxui::Pixel& pixel = screen.PixelAt(x, y);
+			ftxui::Pixel& last = previous[(size_t)y * width + x];
+			if (!redraw && same_cell(pixel, last)) continue;
+			last = pixel;
+
+			// EMPTY CELLS ARE THE RIGHT HALF OF A WIDE GLYPH, THE TERMINAL ALREADY FILLED THEM
+			if (pixel.character.empty()) {
+				cursor_x = -1;
+				continue;
+			}
+
+			// MOVE THE CURSOR, SHORT FORWARD JUMPS ON THE SAME ROW USE CURSOR FORWARD
+			if (cursor_y == y && cursor_x >= 0 && cursor_x < x) {
+				buffer += "\033[";
+				append_int(buffer, x - cursor_x);
+				buffer += 'C';
+			} else if (cursor_y != y || cursor_x != x) {
+				buffer += "\033[";
+				append_int(buffer, y + 1);
+				buffer += ';';
+				append_int(buffer, x + 1);
+				buffer += 'H';
+			}
+
+			// ONLY CHANGE THE PEN WHEN THE CELL NEEDS A DIFFERENT ONE
+			bool blank = pixel.character == " ";
+			if (!blank && pixel.bold != bold) {
+				buffer += pixel.bold ? "\033[1m" : "\033[22m";
+				bold = pixel.bold;
+			}
+			if (!blank && pixel.foreground_color != foreground) {
+				buffer += "\033[";
+				buffer += pixel.foreground_color.Print(false);
+				buffer += 'm';
+				foreground = pixel.foreground_color;
+			}
+			if (pixel.background_color != background) {
+				buffer += "\033[";
+				buffer += pixel.background_color.Print(true);
+				buffer += 'm';
+				background = pixel.background_color;
+			}
+
+			buffer += pixel.character;
+
+			cursor_x = x + 1 < width ? x + 1 : -1;
+			cursor_y = y;
+		}
+	}
+
+	return buffer;
+}
+
+const char* output_mode_name(OutputMode mode) {
+	switch (mode) {
+		case OutputMode::Ftxui: return "ftxui";
+		case OutputMode::Ansi16: return "ansi16";
+		case OutputMode::Ansi256: return "ansi256";
+		case OutputMode::TrueColor: return "truecolor";
+		case OutputMode::Ppm: return "ppm";
+	}
+	return "?";
+}
+
+bool parse_output_mode(const char* name, OutputMode& mode) {
+	for (OutputMode candidate : {OutputMode::Ftxui, OutputMode::Ansi16, OutputMode::Ansi256, OutputMode::TrueColor, OutputMode::Ppm}) {
+		if (std::strcmp(name, output_mode_name(candidate)) == 0) {
+			mode = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::unique_ptr<FrameEncoder> make_encoder(OutputMode mode) {
+	switch (mode) {
+		case OutputMode::Ftxui: return std::make_unique<FtxuiEncoder>();
+		case OutputMode::Ppm: return std::make_unique<PpmEncoder>();
+		default: return std::make_unique<AnsiEncoder>(mode);
+	}
+}
+
+static ftxui::Color palette_color(uint8_t color) {
+	return color < 16 ? ftxui::Color((ftxui::Color::Palette16)color) : ftxui::Color((ftxui::Color::Palette256)color);
+}
+
+void copy_to_screen(const Framebuffer& frame, ftxui::Screen& screen) {
+	if (screen.dimx() != frame.width || screen.dimy() != frame.height) {
+		screen = ftxui::Screen(frame.width, frame.height);
+	}
+	for (int y = 0; y < frame.height; y++) {
+		const Cell* row = frame.row(y);
+		for (int x = 0; x < frame.width; x++) {
+			ftxui::Pixel& pixel = screen.PixelAt(x, y);
+			const Cell& cell = row[x];
+			if (block_glyph(cell)) {
+				pixel.character = quadrant_utf8(cell.glyph & GLYPH_QUADRANTS);
+			} else {
+				pixel.character = cell.glyph;
+			}
+			pixel.foreground_color = palette_color(cell.color);
+			int background = background_color(cell);
+			pixel.background_color = background < 0 ? ftxui::Color(ftxui::Color::Default) : palette_color((uint8_t)background);
+			pixel.bold = cell.bold;
+		}
+	}
+}
+
+void FtxuiEncoder::invalidate() {
+	output.invalidate();
+}
+
+const std::string& FtxuiEncoder::encode(const Framebuffer& frame) {
+	copy_to_screen(frame, screen);
+	return output.encode(screen);
+}
+
+// NEAREST NAMED COLOR OF EVERY PALETTE INDEX, FOR 16 COLOR TERMINALS
+static const std::array<uint8_t, 256> nearest_named = [] {
+	std::array<uint8_t, 256> table{};
+	for (int color = 0; color < 256; color++) {
+		Rgb rgb = palette_rgb((uint8_t)color);
+		int best_distance = -1;
+		for (int named = 0; named < 16; named++) {
+			Rgb candidate = palette_rgb((uint8_t)named);
+			int dr = rgb.r - candidate.r, dg = rgb.g - candidate.g, db = rgb.b - candidate.b;
+			int distance = dr * dr + dg * dg + db * db;
+			if (best_distance < 0 || distance < best_distance) {
+				best_distance = distance;
+				table[color] = (uint8_t)named;
+			}
+		}
+	}
+	return table;
+}();
+
+// PALETTE INDEX AS AN SGR PARAMETER FOR mode, FOREGROUND OR BACKGROUND
+static void append_color(std::string& out, OutputMode mode, uint8_t color, bool background) {
+	if (mode == OutputMode::Ansi16) {
+		uint8_t named = nearest_named[color];
+		append_int(out, (named < 8 ? 30 + named : 90 + named - 8) + (background ? 10 : 0));
+	} else if (mode == OutputMode::Ansi256) {
+		out += background ? "48;5;" : "38;5;";
+		append_int(out, color);
+	} else {
+		Rgb rgb = palette_rgb(color);
+		out += background ? "48;2;" : "38;2;";
+		append_int(out, rgb.r);
+		out += ';';
+		append_int(out, rgb.g);
+		out += ';';
+		append_int(out, rgb.b);
+	}
+}
+
+void AnsiEncoder::invalidate() {
+	width = 0;
+	height = 0;
+}
+
+const std::string& AnsiEncoder::encode(const Framebuffer& frame) {
+	buffer.clear();
+
+	// SIZE CHANGE (OR INVALIDATE) MEANS A FULL REDRAW FROM A KNOWN PEN STATE
+	bool redraw = frame.width != width || frame.height != height;
+	if (redraw) {
+		width = frame.width;
+		height = frame.height;
+		previous.assign((size_t)width * height, Cell());
+		color = -1;
+		background = -1;
+		bold = false;
+		buffer += "\033[0m\033[2J\033[?25l";
+	}
+
+	// -1 WHEN THE CURSOR POSITION IS UNKNOWN (START OF FRAME OR PENDING WRAP AT THE RIGHT EDGE)
+	int cursor_x = -1;
+	int cursor_y = -1;
+
+	for (int y = 0; y < height; y++) {
+		const Cell* row = frame.row(y);
+		Cell* last_row = &previous[(size_t)y * width];
+		for (int x = 0; x < width; x++) {
+			const Cell& cell = row[x];
+			Cell& last = last_row[x];
+
+			// BLANK CELLS ONLY SHOW THE BACKGROUND, LEFTOVER COLOR/BOLD DOES NOT MAKE THEM DIFFERENT
+			bool blank = cell.glyph == ' ';
+			if (!redraw && (blank ? last.glyph == ' ' : cell == last)) continue;
+			last = cell;
+
+			// MOVE THE CURSOR, SHORT FORWARD JUMPS ON THE SAME ROW USE CURSOR FORWARD
+			if (cursor_y == y && cursor_x >= 0 && cursor_x < x) {
+				buffer += "\033[";
+				append_int(buffer, x - cursor_x);
+				buffer += 'C';
+			} else if (cursor_y != y || cursor_x != x) {
+				buffer += "\033[";
+				append_int(buffer, y + 1);
+				buffer += ';';
+				append_int(buffer, x + 1);
+				buffer += 'H';
+			}
+
+			// ONLY CHANGE THE PEN WHEN THE CELL NEEDS A DIFFERENT ONE
+			if (!blank && (bool)cell.bold != bold) {
+				buffer += cell.bold ? "\033[1m" : "\033[22m";
+				bold = cell.bold;
+			}
+			if (!blank && cell.color != color) {
+				buffer += "\033[";
+				append_color(buffer, mode, cell.color, false);
+				buffer += 'm';
+				color = cell.color;
+			}
+			int cell_background = background_color(cell);
+			if (cell_background != background) {
+				buffer += "\033[";
+				if (cell_background < 0) {
+					buffer += "49";
+				} else {
+					append_color(buffer, mode, (uint8_t)cell_background, true);
+				}
+				buffer += 'm';
+				background = cell_background;
+			}
+
+			if (block_glyph(cell)) {
+				buffer += quadrant_utf8(cell.glyph & GLYPH_QUADRANTS);
+			} else {
+				buffer += cell.glyph;
+			}
+
+			cursor_x = x + 1 < width ? x + 1 : -1;
+			cursor_y = y;
+		}
+	}
+
+	return buffer;
+}
+
+// TOP OR BOTTOM PIXEL OF A CELL: A SUB-CELL GLYPH SHOWS ITS LEFT QUADRANT (quadrant IS 1 OR 4) OR ITS BACKGROUND
+static Rgb cell_rgb(const Cell& cell, uint8_t quadrant) {
+	if (!block_glyph(cell)) return cell.glyph == ' ' ? Rgb{0, 0, 0} : palette_rgb(cell.color);
+	if (cell.glyph & quadrant) return palette_rgb(cell.color);
+	int background = background_color(cell);
+	return background < 0 ? Rgb{0, 0, 0} : palette_rgb((uint8_t)background);
+}
+
+// EACH CELL IS ONE PIXEL WIDE AND TWO HIGH (ROUGHLY THE SHAPE OF A TERMINAL CELL), BLANKS ARE BLACK
+const std::string& PpmEncoder::encode(const Framebuffer& frame) {
+	buffer = "P6\n";
+	append_int(buffer, frame.width);
+	buffer += ' ';
+	append_int(buffer, frame.height * 2);
+	buffer += "\n255\n";
+
+	size_t header = buffer.size();
+	size_t row_bytes = (size_t)frame.width * 3;
+	buffer.resize(header + row_bytes * frame.height * 2);
+	for (int y = 0; y < frame.height; y++) {
+		const Cell* row = frame.row(y);
+		char* out = &buffer[header + row_bytes * y * 2];
+		for (int x = 0; x < frame.width; x++) {
+			Rgb top = cell_rgb(row[x], 1);
+			Rgb bottom = cell_rgb(row[x], 4);
+			out[x * 3 + 0] = (char)top.r;
+			out[x * 3 + 1] = (char)top.g;
+			out[x * 3 + 2] = (char)top.b;
+			out[row_bytes + x * 3 + 0] = (char)bottom.r;
+			out[row_bytes + x * 3 + 1] = (char)bottom.g;
+			out[row_bytes + x * 3 + 2] = (char)bottom.b;
+		}
+	}
+	return buffer;
+}
+
+FrameWriter::FrameWriter(int fd, std::unique_ptr<FrameEncoder> encoder) : fd(fd), encoder(std::move(encoder)) {
+	thread = std::thread(&FrameWriter::writer_loop, this);
+}
+
+FrameWriter::~FrameWriter() {
+	stop();
+}
+
+void FrameWriter::stop() {
+	if (!thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	thread.join();
+}
+
+static int64_t steady_nanoseconds() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double FrameWriter::output_seconds() const {
+	int64_t duration = output_duration.load(std::memory_order_relaxed);
+	int64_t start = output_start.load(std::memory_order_relaxed);
+	if (start != 0) duration = std::max(duration, steady_nanoseconds() - start);
+	return duration * 1e-9;
+}
+
+void FrameWriter::publish(Framebuffer& frame) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (has_pending) dropped_frames.fetch_add(1, std::memory_order_relaxed);
+		std::swap(frame, pending);
+		has_pending = true;
+	}
+	wake.notify_one();
+}
+
+// TAKES THE NEWEST FRAME, ENCODES IT AGAINST THE LAST ONE WRITTEN AND BLOCKS ON THE DESCRIPTOR UNTIL IT IS OUT
+void FrameWriter::writer_loop() {
+	profile_thread = PROFILE_THREAD_WRITER;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || has_pending; });
+			if (stopping) return;
+			std::swap(pending, writing);
+			has_pending = false;
+		}
+		int64_t start = steady_nanoseconds();
+		output_start.store(start, std::memory_order_relaxed);
+
+		ScopedTimer encode_timer(STAGE_ENCODE);
+		const std::string& bytes = encoder->encode(writing);
+		encode_timer.stop();
+
+		ScopedTimer write_timer(STAGE_WRITE);
+		size_t written = 0;
+		while (written < bytes.size()) {
+			ssize_t n = write(fd, bytes.data() + written, bytes.size() - written);
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) break;
+			written += (size_t)n;
+		}
+
+		// A FAILED WRITE LEAVES THE TERMINAL IN AN UNKNOWN STATE, REDRAW EVERYTHING NEXT TIME
+		if (written < bytes.size()) encoder->invalidate();
+
+		output_duration.store(steady_nanoseconds() - start, std::memory_order_relaxed);
+		output_start.store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ftxui/screen/screen.hpp>
+#include "Framebuffer.hpp"
+
+// TURNS FRAMEBUFFERS INTO BYTES, EITHER FOR A TERMINAL (ONLY WHAT CHANGED SINCE THE LAST FRAME) OR AS A WHOLE IMAGE
+struct FrameEncoder {
+	virtual ~FrameEncoder() = default;
+
+	// FORCES THE NEXT FRAME TO BE A FULL REDRAW (EG. AFTER THE TERMINAL WAS CLEARED)
+	virtual void invalidate() = 0;
+
+	// RETURNS THE BYTES FOR frame, THE REFERENCE STAYS VALID UNTIL THE NEXT CALL
+	virtual const std::string& encode(const Framebuffer& frame) = 0;
+};
+
+// FTXUI: COPIES INTO AN ftxui::Screen AND DIFFS ITS PIXELS (THE ORIGINAL PATH, KEPT FOR COMPARISON)
+// ANSI16/ANSI256/TRUECOLOR: DIFFS CELLS DIRECTLY, COLORS AS SGR 30-37/90-97, 38;5;N OR 38;2;R;G;B
+// PPM: BINARY PPM IMAGE OF THE WHOLE FRAME, 1x2 PIXELS PER CELL (HEADLESS SNAPSHOTS ONLY)
+// SUB-CELL GLYPHS ARE WRITTEN AS UTF-8 BLOCK ELEMENTS WITH AN SGR BACKGROUND WHERE THE CELL HAS ONE
+enum class OutputMode {
+	Ftxui,
+	Ansi16,
+	Ansi256,
+	TrueColor,
+	Ppm,
+};
+
+const char* output_mode_name(OutputMode mode);
+
+// FALSE FOR AN UNKNOWN NAME
+bool parse_output_mode(const char* name, OutputMode& mode);
+
+std::unique_ptr<FrameEncoder> make_encoder(OutputMode mode);
+
+// COPIES frame INTO screen (RESIZING IT IF NEEDED), FOR THE FTXUI ENCODER AND THE ToString REFERENCE IN --bench
+void copy_to_screen(const Framebuffer& frame, ftxui::Screen& screen);
+
+// KEEPS THE LAST EMITTED FRAME AND ENCODES ONLY THE CELLS THAT CHANGED SINCE THEN
+// CURSOR MOVES AND COLOR/BOLD CHANGES ARE ONLY EMITTED WHEN THEY ACTUALLY DIFFER
+struct TerminalOutput {
+	int width = 0;
+	int height = 0;
+	std::vector<ftxui::Pixel> previous;
+	std::string buffer;
+
+	// PEN STATE OF THE TERMINAL AFTER THE LAST ENCODED FRAME
+	ftxui::Color foreground = ftxui::Color::Default;
+	ftxui::Color background = ftxui::Color::Default;
+	bool bold = false;
+
+	// FORCES THE NEXT FRAME TO BE A FULL REDRAW (EG. AFTER THE TERMINAL WAS CLEARED)
+	void invalidate();
+
+	// RETURNS THE BYTES THAT TURN THE PREVIOUS FRAME INTO screen, REUSING buffer
+	const std::string& encode(const ftxui::Screen& screen);
+};
+
+struct FtxuiEncoder : FrameEncoder {
+	ftxui::Screen screen = ftxui::Screen(0, 0);
+	TerminalOutput output;
+
+	void invalidate() override;
+	const std::string& encode(const Framebuffer& frame) override;
+};
+
+// SAME DIFFING AS TerminalOutput BUT ON 4 BYTE CELLS, NO ftxui::Pixel OR COLOR OBJECTS ON THE WAY
+struct AnsiEncoder : FrameEncoder {
+	OutputMode mode;
+	int width = 0;
+	int height = 0;
+	std::vector<Cell> previous;
+	std::string buffer;
+
+	// PEN STATE OF THE TERMINAL AFTER THE LAST ENCODED FRAME (COLOR -1 = TERMINAL DEFAULT)
+	int color = -1;
+	int background = -1;
+	bool bold = false;
+
+	explicit AnsiEncoder(OutputMode mode) : mode(mode) {}
+	void invalidate() override;
+	const std::string& encode(const Framebuffer& frame) override;
+};
+
+struct PpmEncoder : FrameEncoder {
+	std::string buffer;
+
+	void invalidate() override {}
+	const std::string& encode(const Framebuffer& frame) override;
+};
+
+// WRITES FRAMES TO A FILE DESCRIPTOR ON ITS OWN THREAD SO A SLOW TERMINAL NEVER STALLS INPUT OR ANIMATION
+// THREE FRAMEBUFFERS ROTATE BY SWAPPING: THE CALLER'S, THE PENDING ONE AND THE ONE BEING WRITTEN
+// ONLY THE LATEST FRAME IS KEPT, A FRAME PUBLISHED BEFORE THE WRITER TOOK THE LAST ONE REPLACES IT
+struct FrameWriter {
+	FrameWriter(int fd, std::unique_ptr<FrameEncoder> encoder);
+	FrameWriter(const FrameWriter&) = delete;
+	FrameWriter& operator=(const FrameWriter&) = delete;
+	~FrameWriter();
+
+	// HANDS frame TO THE WRITER AND GIVES BACK AN OLDER FRAMEBUFFER TO DRAW THE NEXT FRAME INTO (ANY SIZE, ANY CONTENT)
+	void publish(Framebuffer& frame);
+
+	// STOPS THE WRITER THREAD, A FRAME STILL PENDING IS NOT WRITTEN
+	void stop();
+
+	// FRAMES REPLACED BEFORE THEY WERE WRITTEN
+	uint64_t dropped() const { return dropped_frames.load(std::memory_order_relaxed); }
+
+	// SECONDS THE WRITER NEEDS PER FRAME: ENCODING AND WRITING THE LAST FRAME, OR THE ONE STILL BEING WRITTEN IF THAT
+	// TOOK LONGER ALREADY (A TERMINAL THAT STOPPED READING SHOWS UP BEFORE ITS WRITE RETURNS), FOR THE FRAME PACER
+	double output_seconds() const;
+
+	int fd;
+	std::unique_ptr<FrameEncoder> encoder;
+	Framebuffer pending;
+	Framebuffer writing;
+	bool has_pending = false;
+	bool stopping = false;
+	std::atomic<uint64_t> dropped_frames{0};
+
+	// STEADY CLOCK NANOSECONDS: WHEN THE FRAME BEING OUTPUT WAS TAKEN (0 WHILE WAITING), HOW LONG THE LAST ONE TOOK
+	std::atomic<int64_t> output_start{0};
+	std::atomic<int64_t> output_duration{0};
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::thread thread;
+
+	void writer_loop();
+};
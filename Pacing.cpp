@@ -0,0 +1,36 @@
+#include "Pacing.hpp"
+
+// FRAMES OVER BUDGET BEFORE HALVING THE RATE, AND FRAMES WITH HEADROOM BEFORE DOUBLING IT AGAIN
+static const int DROP_AFTER = 3;
+static const int RAISE_AFTER = 60;
+static const int SLOWEST_LEVEL = 2;
+
+double FramePacer::fps() const {
+	return cap / (double)(1 << level);
+}
+
+double FramePacer::frame_seconds() const {
+	return 1.0 / fps();
+}
+
+void FramePacer::record(double work_seconds) {
+	if (work_seconds > frame_seconds()) {
+		under_budget = 0;
+		if (++over_budget >= DROP_AFTER && level < SLOWEST_LEVEL) {
+			level++;
+			over_budget = 0;
+		}
+		return;
+	}
+	over_budget = 0;
+
+	// ONLY SPEED BACK UP WHEN FRAMES WOULD USE AT MOST HALF OF THE FASTER BUDGET
+	if (level > 0 && work_seconds < 0.5 * frame_seconds() / 2.0) {
+		if (++under_budget >= RAISE_AFTER) {
+			level--;
+			under_budget = 0;
+		}
+	} else {
+		under_budget = 0;
+	}
+}
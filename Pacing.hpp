@@ -0,0 +1,24 @@
+#pragma once
+
+// FIXED SIMULATION RATE, TURN ANIMATIONS AND CAMERA DAMPING ADVANCE ONE STEP AT A TIME
+// SO THEY TAKE THE SAME WALL CLOCK TIME NO MATTER HOW FAST FRAMES ARE DRAWN
+constexpr double SIM_STEP = 1.0 / 60.0;
+
+// UPPER BOUND ON STEPS CAUGHT UP IN ONE FRAME, LONGER STALLS ARE DROPPED INSTEAD OF REPLAYED
+constexpr int MAX_SIM_STEPS = 8;
+
+// PICKS THE FRAME RATE FROM cap, cap / 2 AND cap / 4 (EG. 60/30/15) BY HOW LONG FRAMES ACTUALLY TAKE
+struct FramePacer {
+	double cap = 60.0;
+	int level = 0;
+
+	// CONSECUTIVE FRAMES THAT BLEW THE BUDGET / WOULD HAVE FIT THE NEXT FASTER RATE
+	int over_budget = 0;
+	int under_budget = 0;
+
+	double fps() const;
+	double frame_seconds() const;
+
+	// FEEDS THE TIME SPENT PRODUCING ONE FRAME (EXCLUDING THE PACING SLEEP)
+	void record(double work_seconds);
+};
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cstdio>
+#include "Profile.hpp"
+
+Profiler profiler;
+thread_local ProfileThread profile_thread = PROFILE_THREAD_MAIN;
+
+const char* stage_name(ProfileStage stage) {
+	static const char* const names[STAGE_COUNT] = {"input", "transform", "project", "raster", "encode", "write", "frame"};
+	return names[stage];
+}
+
+void Profiler::record(ProfileStage stage, Clock::time_point start, Clock::time_point end) {
+	float ms = std::chrono::duration<float, std::milli>(end - start).count();
+	std::lock_guard<std::mutex> lock(mutex);
+	samples[stage][counts[stage] % PROFILE_WINDOW] = ms;
+	counts[stage]++;
+
+	if (tracing && events.size() < TRACE_EVENT_LIMIT) {
+		auto us = [&](Clock::time_point t) {
+			return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(t - origin).count();
+		};
+		events.push_back({(uint8_t)stage, (uint8_t)profile_thread, us(start), us(end) - us(start)});
+	}
+}
+
+StageSummary Profiler::summary(ProfileStage stage) const {
+	StageSummary s;
+	std::array<float, PROFILE_WINDOW> sorted;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		s.samples = std::min(counts[stage], PROFILE_WINDOW);
+		std::copy(samples[stage].begin(), samples[stage].begin() + s.samples, sorted.begin());
+	}
+	if (s.samples == 0) return s;
+
+	double total = 0.0;
+	for (int i = 0; i < s.samples; i++) total += sorted[i];
+
+	// NEAREST RANK PERCENTILE
+	int rank = (99 * s.samples + 99) / 100 - 1;
+	std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + s.samples);
+	s.p99_ms = sorted[rank];
+	s.min_ms = *std::min_element(sorted.begin(), sorted.begin() + s.samples);
+	s.avg_ms = total / s.samples;
+	return s;
+}
+
+bool Profiler::write_trace(const std::string& path) const {
+	FILE* file = std::fopen(path.c_str(), "w");
+	if (!file) return false;
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"main\"}},\n", PROFILE_THREAD_MAIN);
+	std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"writer\"}}", PROFILE_THREAD_WRITER);
+	for (const TraceEvent& e : events) {
+		std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%u,\"dur\":%u}",
+			stage_name((ProfileStage)e.stage), e.thread, e.start_us, e.duration_us);
+	}
+	std::fprintf(file, "\n]}\n");
+	return std::fclose(file) == 0;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// STAGES OF A FRAME TIMED BY THE PROFILER
+enum ProfileStage {
+	STAGE_INPUT,     // KEY POLLING AND MOVE MAPPING
+	STAGE_TRANSFORM, // STARTING AND ADVANCING TURN ANIMATIONS (FIXED SIMULATION STEPS)
+	STAGE_PROJECT,   // VISIBILITY PRE-PASS AND VERTEX PROJECTION OF THE CUBE UNITS
+	STAGE_RASTER,    // TILED TRIANGLE RASTERIZATION
+	STAGE_ENCODE,    // SCREEN TO TERMINAL BYTES (DIFF AGAINST THE LAST WRITTEN FRAME, WRITER THREAD)
+	STAGE_WRITE,     // WRITING THE BYTES TO THE TERMINAL (WRITER THREAD)
+	STAGE_FRAME,     // INPUT TO PUBLISHING THE FRAME ON THE MAIN THREAD, EXCLUDING THE PACING SLEEP
+	STAGE_COUNT
+};
+
+// THREADS SHOWN AS SEPARATE TRACKS IN THE TRACE
+enum ProfileThread : uint8_t {
+	PROFILE_THREAD_MAIN = 1,
+	PROFILE_THREAD_WRITER = 2,
+};
+
+// THREAD THE CALLING THREAD'S SAMPLES ARE ATTRIBUTED TO
+extern thread_local ProfileThread profile_thread;
+
+// SAMPLES KEPT PER STAGE FOR THE ROLLING STATISTICS
+constexpr int PROFILE_WINDOW = 256;
+
+// TRACE EVENTS KEPT FOR THE CHROME TRACE, LATER ONES ARE DROPPED (ABOUT 40 MINUTES AT 60 FPS)
+constexpr size_t TRACE_EVENT_LIMIT = 1 << 20;
+
+struct StageSummary {
+	int samples = 0;
+	double min_ms = 0.0;
+	double avg_ms = 0.0;
+	double p99_ms = 0.0;
+};
+
+// SCOPED TIMERS FEED IT FROM THE MAIN AND WRITER THREADS, NOTHING IS RECORDED UNLESS enabled OR TRACING
+struct Profiler {
+	using Clock = std::chrono::steady_clock;
+
+	std::atomic<bool> enabled{false};
+	bool tracing = false;
+	Clock::time_point origin = Clock::now();
+
+	// RING BUFFER OF THE LAST PROFILE_WINDOW DURATIONS (MS) PER STAGE
+	std::array<std::array<float, PROFILE_WINDOW>, STAGE_COUNT> samples = {};
+	std::array<int, STAGE_COUNT> counts = {};
+
+	// COMPLETE EVENTS ("ph":"X") IN MICROSECONDS SINCE origin
+	struct TraceEvent {
+		uint8_t stage;
+		uint8_t thread;
+		uint32_t start_us;
+		uint32_t duration_us;
+	};
+	std::vector<TraceEvent> events;
+
+	// GUARDS samples, counts AND events
+	mutable std::mutex mutex;
+
+	bool active() const { return enabled.load(std::memory_order_relaxed) || tracing; }
+
+	void record(ProfileStage stage, Clock::time_point start, Clock::time_point end);
+
+	StageSummary summary(ProfileStage stage) const;
+
+	// WRITES THE TRACE IN CHROME TRACE EVENT FORMAT (chrome://tracing, PERFETTO), FALSE IF IT CANNOT BE WRITTEN
+	bool write_trace(const std::string& path) const;
+};
+extern Profiler profiler;
+
+const char* stage_name(ProfileStage stage);
+
+// TIMES ITS SCOPE AS ONE SAMPLE OF stage
+struct ScopedTimer {
+	ProfileStage stage;
+	bool active;
+	Profiler::Clock::time_point start;
+
+	explicit ScopedTimer(ProfileStage stage) : stage(stage), active(profiler.active()) {
+		if (active) start = Profiler::Clock::now();
+	}
+	~ScopedTimer() { stop(); }
+
+	// DROPS THE SAMPLE
+	void cancel() { active = false; }
+
+	// ENDS THE SAMPLE BEFORE THE SCOPE DOES
+	void stop() {
+		if (active) profiler.record(stage, start, Profiler::Clock::now());
+		active = false;
+	}
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
@@ -0,0 +1,376 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "Raster.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RASTER_X86 1
+#endif
+
+// VERTEX COORDINATES ARE SNAPPED TO 1/8 OF A CELL, EDGE FUNCTIONS ARE EXACT 32 BIT INTEGERS
+static const int SUBPIXEL_BITS = 3;
+static const int SUBPIXEL = 1 << SUBPIXEL_BITS;
+
+// TRIANGLES REACHING FURTHER THAN THIS (IN CELLS) WOULD OVERFLOW THE EDGE FUNCTIONS AND ARE DROPPED
+static const float GUARD_BAND = 1024.0f;
+
+// EDGE FUNCTIONS OF ONE TRIANGLE AT THE CENTER OF CELL (min_x, min_y)
+// DEPTH IS A PLANE z_origin + x * z_step_x + y * z_step_y EVALUATED PER CELL (NOT ACCUMULATED)
+struct TriangleSetup {
+	int min_x, max_x, min_y, max_y;
+	int32_t step_x[3];   // CHANGE OF EACH EDGE FUNCTION PER CELL TO THE RIGHT
+	int32_t step_y[3];   // CHANGE OF EACH EDGE FUNCTION PER CELL DOWN
+	int32_t row[3];      // EDGE FUNCTIONS (BIASED FOR THE TOP-LEFT RULE) AT THE FIRST ROW
+	float z_origin, z_step_x, z_step_y;
+};
+
+// RETURNS FALSE IF THE TRIANGLE IS DEGENERATE, OUTSIDE clip OR OUTSIDE THE GUARD BAND
+static bool setup_triangle(const ScreenTriangle& triangle, const TileRect& clip, TriangleSetup& t) {
+	int32_t x[3], y[3];
+	float z[3];
+	for (int i = 0; i < 3; i++) {
+		const glm::vec3& v = triangle.v[i];
+		if (!(std::fabs(v.x) < GUARD_BAND && std::fabs(v.y) < GUARD_BAND)) return false;
+		x[i] = (int32_t)std::lround(v.x * SUBPIXEL);
+		y[i] = (int32_t)std::lround(v.y * SUBPIXEL);
+		z[i] = v.z;
+	}
+
+	// EDGE i RUNS FROM VERTEX i+1 TO i+2 (OPPOSITE VERTEX i), ORIENT SO THE AREA IS POSITIVE
+	auto area_of = [&]() {
+		return (int64_t)(x[2] - x[1]) * (y[0] - y[1]) - (int64_t)(y[2] - y[1]) * (x[0] - x[1]);
+	};
+	int64_t area = area_of();
+	if (area == 0) return false;
+	if (area < 0) {
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(z[1], z[2]);
+		area = -area;
+	}
+
+	// BOUNDING BOX OF CELLS WHOSE CENTERS MAY BE COVERED, CLIPPED TO THE TILE
+	t.min_x = std::max(clip.min_x, (std::min({x[0], x[1], x[2]}) - SUBPIXEL / 2) >> SUBPIXEL_BITS);
+	t.max_x = std::min(clip.max_x, (std::max({x[0], x[1], x[2]}) - SUBPIXEL / 2) >> SUBPIXEL_BITS);
+	t.min_y = std::max(clip.min_y, (std::min({y[0], y[1], y[2]}) - SUBPIXEL / 2) >> SUBPIXEL_BITS);
+	t.max_y = std::min(clip.max_y, (std::max({y[0], y[1], y[2]}) - SUBPIXEL / 2) >> SUBPIXEL_BITS);
+	if (t.min_x > t.max_x || t.min_y > t.max_y) return false;
+
+	int32_t px = t.min_x * SUBPIXEL + SUBPIXEL / 2;
+	int32_t py = t.min_y * SUBPIXEL + SUBPIXEL / 2;
+	double z_origin = 0.0;
+	for (int i = 0; i < 3; i++) {
+		int a = (i + 1) % 3;
+		int b = (i + 2) % 3;
+		int32_t dx = x[b] - x[a];
+		int32_t dy = y[b] - y[a];
+
+		// TOP-LEFT RULE: CENTERS EXACTLY ON A RIGHT OR BOTTOM EDGE BELONG TO THE NEIGHBOURING TRIANGLE
+		bool top_left = dy < 0 || (dy == 0 && dx > 0);
+		int32_t edge = (int32_t)((int64_t)dx * (py - y[a]) - (int64_t)dy * (px - x[a]));
+		t.row[i] = edge - (top_left ? 0 : 1);
+		t.step_x[i] = -dy * SUBPIXEL;
+		t.step_y[i] = dx * SUBPIXEL;
+
+		// UNBIASED EDGE FUNCTION AT THE CENTER OF CELL (0, 0) IS THE BARYCENTRIC WEIGHT THERE
+		double origin = (double)dx * (SUBPIXEL / 2 - y[a]) - (double)dy * (SUBPIXEL / 2 - x[a]);
+		z_origin += origin * z[i];
+	}
+
+	// DEPTH IS AN AFFINE FUNCTION OF THE EDGE FUNCTIONS (BARYCENTRIC WEIGHTS)
+	t.z_origin = (float)(z_origin / (double)area);
+	t.z_step_x = (t.step_x[0] * z[0] + t.step_x[1] * z[1] + t.step_x[2] * z[2]) / (float)area;
+	t.z_step_y = (t.step_y[0] * z[0] + t.step_y[1] * z[1] + t.step_y[2] * z[2]) / (float)area;
+	return true;
+}
+
+// DEPTH WRITE AND SCREEN WRITE FOR ONE COVERED CELL
+static inline void plot(int x, int y, float z, Framebuffer& screen, uint8_t color, float* zrow) {
+	zrow[x] = z;
+	Cell& cell = screen.at(x, y);
+	cell.glyph = '@';
+	cell.color = color;
+}
+
+// DEPTH OF THE FIRST CELL OF ROW y, EVERY PATH COMPUTES CELL DEPTH AS row_z + x * z_step_x
+static inline float row_depth(const TriangleSetup& t, int y) {
+	return t.z_origin + (float)y * t.z_step_y;
+}
+
+// SCALAR SPAN: TESTS CELLS x0..max_x OF ONE ROW, RETURNS HOW MANY IT WROTE
+static inline int scalar_span(const TriangleSetup& t, int x0, int y, int32_t e0, int32_t e1, int32_t e2, float row_z,
+		Framebuffer& screen, uint8_t color, float* zrow) {
+	int written = 0;
+	for (int x = x0; x <= t.max_x; x++) {
+		float z = row_z + (float)x * t.z_step_x;
+		if ((e0 | e1 | e2) >= 0 && z < zrow[x]) {
+			plot(x, y, z, screen, color, zrow);
+			written++;
+		}
+		e0 += t.step_x[0];
+		e1 += t.step_x[1];
+		e2 += t.step_x[2];
+	}
+	return written;
+}
+
+// EVERY PATH RETURNS THE NUMBER OF CELLS IT WROTE
+static int raster_scalar(const TriangleSetup& t, Framebuffer& screen, uint8_t color, ZBuffer& zbuffer) {
+	int written = 0;
+	int32_t e0 = t.row[0], e1 = t.row[1], e2 = t.row[2];
+	for (int y = t.min_y; y <= t.max_y; y++) {
+		written += scalar_span(t, t.min_x, y, e0, e1, e2, row_depth(t, y), screen, color, &zbuffer.at(0, y));
+		e0 += t.step_y[0];
+		e1 += t.step_y[1];
+		e2 += t.step_y[2];
+	}
+	return written;
+}
+
+#ifdef RASTER_X86
+// SSE2: 8 CELLS PER STEP AS TWO 4 WIDE HALVES
+static int raster_sse2(const TriangleSetup& t, Framebuffer& screen, uint8_t color, ZBuffer& zbuffer) {
+	int written = 0;
+	const __m128i lane = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128 z_step_x = _mm_set1_ps(t.z_step_x);
+	__m128i sx[3], sx4[3];
+	for (int i = 0; i < 3; i++) {
+		// LANE OFFSETS 0..3 TIMES step_x WITHOUT SSE4.1 MULTIPLY
+		int32_t s = t.step_x[i];
+		sx[i] = _mm_setr_epi32(0, s, 2 * s, 3 * s);
+		sx4[i] = _mm_set1_epi32(4 * s);
+	}
+
+	int32_t r0 = t.row[0], r1 = t.row[1], r2 = t.row[2];
+	for (int y = t.min_y; y <= t.max_y; y++) {
+		float* zrow = &zbuffer.at(0, y);
+		float row_z = row_depth(t, y);
+		__m128 row_zv = _mm_set1_ps(row_z);
+		__m128i e0 = _mm_add_epi32(_mm_set1_epi32(r0), sx[0]);
+		__m128i e1 = _mm_add_epi32(_mm_set1_epi32(r1), sx[1]);
+		__m128i e2 = _mm_add_epi32(_mm_set1_epi32(r2), sx[2]);
+
+		int x = t.min_x;
+		for (; x + 7 <= t.max_x; x += 8) {
+			alignas(16) float zs[8];
+			int mask = 0;
+			for (int half = 0; half < 2; half++) {
+				__m128 xs = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(x + half * 4), lane));
+				__m128 z = _mm_add_ps(row_zv, _mm_mul_ps(xs, z_step_x));
+
+				// INSIDE WHEN THE SIGN BIT OF ALL THREE BIASED EDGE FUNCTIONS IS CLEAR
+				__m128i sign = _mm_srai_epi32(_mm_or_si128(_mm_or_si128(e0, e1), e2), 31);
+				__m128 inside = _mm_castsi128_ps(_mm_xor_si128(sign, _mm_set1_epi32(-1)));
+				__m128 closer = _mm_cmplt_ps(z, _mm_loadu_ps(zrow + x + half * 4));
+				mask |= _mm_movemask_ps(_mm_and_ps(inside, closer)) << (half * 4);
+				_mm_store_ps(zs + half * 4, z);
+				e0 = _mm_add_epi32(e0, sx4[0]);
+				e1 = _mm_add_epi32(e1, sx4[1]);
+				e2 = _mm_add_epi32(e2, sx4[2]);
+			}
+			written += __builtin_popcount(mask);
+			while (mask) {
+				int i = __builtin_ctz(mask);
+				plot(x + i, y, zs[i], screen, color, zrow);
+				mask &= mask - 1;
+			}
+		}
+
+		// REMAINING CELLS OF THE ROW
+		written += scalar_span(t, x, y, _mm_cvtsi128_si32(e0), _mm_cvtsi128_si32(e1), _mm_cvtsi128_si32(e2), row_z, screen, color, zrow);
+
+		r0 += t.step_y[0];
+		r1 += t.step_y[1];
+		r2 += t.step_y[2];
+	}
+	return written;
+}
+
+// AVX2: 8 CELLS PER STEP IN ONE REGISTER
+__attribute__((target("avx2")))
+static int raster_avx2(const TriangleSetup& t, Framebuffer& screen, uint8_t color, ZBuffer& zbuffer) {
+	int written = 0;
+	const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256 z_step_x = _mm256_set1_ps(t.z_step_x);
+	__m256i sx[3], sx8[3];
+	for (int i = 0; i < 3; i++) {
+		sx[i] = _mm256_mullo_epi32(lane, _mm256_set1_epi32(t.step_x[i]));
+		sx8[i] = _mm256_set1_epi32(8 * t.step_x[i]);
+	}
+
+	int32_t r0 = t.row[0], r1 = t.row[1], r2 = t.row[2];
+	for (int y = t.min_y; y <= t.max_y; y++) {
+		float* zrow = &zbuffer.at(0, y);
+		float row_z = row_depth(t, y);
+		__m256 row_zv = _mm256_set1_ps(row_z);
+		__m256i e0 = _mm256_add_epi32(_mm256_set1_epi32(r0), sx[0]);
+		__m256i e1 = _mm256_add_epi32(_mm256_set1_epi32(r1), sx[1]);
+		__m256i e2 = _mm256_add_epi32(_mm256_set1_epi32(r2), sx[2]);
+
+		int x = t.min_x;
+		for (; x + 7 <= t.max_x; x += 8) {
+			__m256 xs = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(x), lane));
+			__m256 z = _mm256_add_ps(row_zv, _mm256_mul_ps(xs, z_step_x));
+
+			// SIGN BIT OF (e0 | e1 | e2) IS SET FOR OUTSIDE CELLS
+			__m256 outside = _mm256_castsi256_ps(_mm256_or_si256(_mm256_or_si256(e0, e1), e2));
+			__m256 closer = _mm256_cmp_ps(z, _mm256_loadu_ps(zrow + x), _CMP_LT_OQ);
+			int mask = _mm256_movemask_ps(_mm256_andnot_ps(outside, closer));
+			if (mask) {
+				written += __builtin_popcount(mask);
+				alignas(32) float zs[8];
+				_mm256_store_ps(zs, z);
+				while (mask) {
+					int i = __builtin_ctz(mask);
+					plot(x + i, y, zs[i], screen, color, zrow);
+					mask &= mask - 1;
+				}
+			}
+			e0 = _mm256_add_epi32(e0, sx8[0]);
+			e1 = _mm256_add_epi32(e1, sx8[1]);
+			e2 = _mm256_add_epi32(e2, sx8[2]);
+		}
+
+		// REMAINING CELLS OF THE ROW
+		written += scalar_span(t, x, y, _mm256_extract_epi32(e0, 0), _mm256_extract_epi32(e1, 0), _mm256_extract_epi32(e2, 0), row_z, screen, color, zrow);
+
+		r0 += t.step_y[0];
+		r1 += t.step_y[1];
+		r2 += t.step_y[2];
+	}
+	return written;
+}
+#endif
+
+// ONLY REALLOCATES WHEN THE SIZE CHANGES
+void ZBuffer::resize(int w, int h) {
+	if (w == width && h == height) return;
+	width = w;
+	height = h;
+	depth.assign((size_t)w * h, INFINITY);
+	coarse_x = (w + COARSE_WIDTH - 1) / COARSE_WIDTH;
+	coarse_y = (h + COARSE_HEIGHT - 1) / COARSE_HEIGHT;
+	coarse.assign((size_t)coarse_x * coarse_y, INFINITY);
+	stale.assign((size_t)coarse_x * coarse_y, 0);
+}
+
+void ZBuffer::clear() {
+	std::fill(depth.begin(), depth.end(), INFINITY);
+	std::fill(coarse.begin(), coarse.end(), INFINITY);
+	std::fill(stale.begin(), stale.end(), 0);
+}
+
+float ZBuffer::coarse_depth(int bx, int by) {
+	size_t block = (size_t)by * coarse_x + bx;
+	if (stale[block]) {
+		// BLOCKS ON THE RIGHT AND BOTTOM EDGE MAY HANG OVER THE SCREEN
+		float farthest = -INFINITY;
+		int x1 = std::min(width, (bx + 1) * COARSE_WIDTH);
+		int y1 = std::min(height, (by + 1) * COARSE_HEIGHT);
+		for (int y = by * COARSE_HEIGHT; y < y1; y++) {
+			const float* row = &depth[(size_t)y * width];
+			for (int x = bx * COARSE_WIDTH; x < x1; x++) farthest = std::max(farthest, row[x]);
+		}
+		coarse[block] = farthest;
+		stale[block] = 0;
+	}
+	return coarse[block];
+}
+
+void ZBuffer::invalidate_coarse() {
+	std::fill(stale.begin(), stale.end(), 1);
+}
+
+long ZBuffer::covered() const {
+	return (long)std::count_if(depth.begin(), depth.end(), [](float z) { return z != INFINITY; });
+}
+
+static RasterPath detect_raster_path() {
+#ifdef RASTER_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) return RasterPath::AVX2;
+	if (__builtin_cpu_supports("sse2")) return RasterPath::SSE2;
+#endif
+	return RasterPath::Scalar;
+}
+
+static RasterPath current_raster_path = detect_raster_path();
+
+RasterPath raster_path() {
+	return current_raster_path;
+}
+
+bool set_raster_path(RasterPath path) {
+	if (path == RasterPath::AVX2 && detect_raster_path() != RasterPath::AVX2) return false;
+	if (path == RasterPath::SSE2 && detect_raster_path() == RasterPath::Scalar) return false;
+	current_raster_path = path;
+	return true;
+}
+
+static bool coarse_rejection = false;
+
+bool depth_rejection() {
+	return coarse_rejection;
+}
+
+void set_depth_rejection(bool enabled) {
+	coarse_rejection = enabled;
+}
+
+const char* raster_path_name(RasterPath path) {
+	switch (path) {
+		case RasterPath::AVX2: return "avx2";
+		case RasterPath::SSE2: return "sse2";
+		default: return "scalar";
+	}
+}
+
+// COVERED CELL CENTERS LIE INSIDE THE (SNAPPED) TRIANGLE, SO THEIR DEPTH IS A WEIGHTED AVERAGE OF THE VERTEX DEPTHS
+// AND NEVER NEARER THAN THE NEAREST VERTEX, EXCEPT FOR ROUNDING IN THE DEPTH PLANE WHICH THIS MARGIN COVERS
+static const float COARSE_DEPTH_MARGIN = 1e-5f;
+
+// TRUE IF EVERY BLOCK UNDER THE BOUNDING BOX IS ALREADY COVERED BY SOMETHING AT LEAST AS NEAR AS nearest
+static bool behind_coarse(const TriangleSetup& t, float nearest, ZBuffer& zbuffer) {
+	for (int by = t.min_y / COARSE_HEIGHT; by <= t.max_y / COARSE_HEIGHT; by++) {
+		for (int bx = t.min_x / COARSE_WIDTH; bx <= t.max_x / COARSE_WIDTH; bx++) {
+			if (zbuffer.coarse_depth(bx, by) > nearest) return false;
+		}
+	}
+	return true;
+}
+
+// EDGE FUNCTION TRIANGLE FILL (TOP-LEFT RULE, WATERTIGHT ACROSS SHARED EDGES) LIMITED TO clip
+// BLOCKS ARE NEVER SHARED BETWEEN SCREEN TILES, SO THE COARSE BUFFER NEEDS NO LOCKING EITHER
+void fill_triangle(const ScreenTriangle& triangle, const TileRect& clip, Framebuffer& screen, ZBuffer& zbuffer, RasterCounts& counts) {
+	TriangleSetup t;
+	if (!setup_triangle(triangle, clip, t)) return;
+	counts.triangles++;
+
+	if (coarse_rejection) {
+		float nearest = std::min({triangle.v[0].z, triangle.v[1].z, triangle.v[2].z}) - COARSE_DEPTH_MARGIN;
+		if (behind_coarse(t, nearest, zbuffer)) {
+			counts.rejected++;
+			return;
+		}
+	}
+
+	int written;
+	switch (current_raster_path) {
+#ifdef RASTER_X86
+		case RasterPath::AVX2: written = raster_avx2(t, screen, triangle.color, zbuffer); break;
+		case RasterPath::SSE2: written = raster_sse2(t, screen, triangle.color, zbuffer); break;
+#endif
+		default: written = raster_scalar(t, screen, triangle.color, zbuffer); break;
+	}
+	counts.cells += written;
+
+	// WHILE REJECTION IS OFF THE BLOCKS STAY AT INFINITY FROM THE LAST clear, WHICH NEVER REJECTS ANYTHING
+	if (written == 0 || !coarse_rejection) return;
+
+	for (int by = t.min_y / COARSE_HEIGHT; by <= t.max_y / COARSE_HEIGHT; by++) {
+		for (int bx = t.min_x / COARSE_WIDTH; bx <= t.max_x / COARSE_WIDTH; bx++) {
+			zbuffer.stale[(size_t)by * zbuffer.coarse_x + bx] = 1;
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Framebuffer.hpp"
+#include <glm/glm.hpp>
+
+// CELLS PER BLOCK OF THE COARSE DEPTH BUFFER (THE SCREEN TILES ARE WHOLE MULTIPLES OF IT)
+constexpr int COARSE_WIDTH = 8;
+constexpr int COARSE_HEIGHT = 4;
+
+// CONTIGUOUS ROW MAJOR DEPTH BUFFER
+// NEXT TO IT THE FARTHEST DEPTH OF EVERY COARSE BLOCK OF CELLS, WHICH LETS fill_triangle DROP A TRIANGLE THAT IS
+// BEHIND EVERYTHING ALREADY DRAWN WITHOUT TESTING ITS CELLS (A BLOCK WRITTEN SINCE IT WAS LAST READ IS stale AND
+// RECOMPUTED ON THE NEXT READ, SO WRITES STAY CHEAP)
+struct ZBuffer {
+	int width = 0;
+	int height = 0;
+	std::vector<float> depth;
+
+	int coarse_x = 0;
+	int coarse_y = 0;
+	std::vector<float> coarse;
+	std::vector<uint8_t> stale;
+
+	void resize(int w, int h);
+	void clear();
+	float& at(int x, int y) { return depth[(size_t)y * width + x]; }
+
+	// FARTHEST DEPTH IN BLOCK (bx, by)
+	float coarse_depth(int bx, int by);
+
+	// MARKS EVERY BLOCK stale, NEEDED AFTER WRITING depth DIRECTLY
+	void invalidate_coarse();
+
+	// CELLS SOMETHING WAS DRAWN INTO SINCE THE LAST clear
+	long covered() const;
+};
+
+// PROJECTED TRIANGLE READY FOR RASTERIZATION, VERTICES IN CONTINUOUS CELL COORDINATES (x, y) WITH DEPTH z
+struct ScreenTriangle {
+	glm::vec3 v[3];
+	uint8_t color;
+};
+
+// WORK DONE BY fill_triangle, ADDED UP BY THE CALLER (A TRIANGLE SPLIT OVER SEVERAL TILES COUNTS ONCE PER TILE)
+struct RasterCounts {
+	long triangles = 0; // TRIANGLES WITH CELLS INSIDE THE CLIP RECTANGLE
+	long rejected = 0;  // OF THOSE, DROPPED BY THE COARSE DEPTH TEST BEFORE ANY CELL WAS TESTED
+	long cells = 0;     // CELLS WRITTEN, A CELL DRAWN OVER TWICE COUNTS TWICE
+
+	void add(const RasterCounts& other) {
+		triangles += other.triangles;
+		rejected += other.rejected;
+		cells += other.cells;
+	}
+};
+
+// INCLUSIVE CELL RECTANGLE THE RASTERIZER IS ALLOWED TO TOUCH
+struct TileRect {
+	int min_x, min_y, max_x, max_y;
+};
+
+// RASTERIZER IMPLEMENTATIONS, THE FASTEST ONE THE CPU SUPPORTS IS PICKED AT STARTUP
+enum class RasterPath { Scalar, SSE2, AVX2 };
+
+RasterPath raster_path();
+
+// FORCES A PATH (EG. FOR BENCHMARKING), RETURNS FALSE IF THE CPU DOES NOT SUPPORT IT
+bool set_raster_path(RasterPath path);
+
+const char* raster_path_name(RasterPath path);
+
+// COARSE DEPTH REJECTION (AND THE FRONT TO BACK ORDER THAT FEEDS IT), OFF BY DEFAULT: THE VISIBILITY PRE-PASS
+// ALREADY LEAVES ALMOST NOTHING HIDDEN, SO IT COSTS MORE THAN IT SAVES ON THESE SCENES
+// THE DEPTH TEST KEEPS THE FIRST TRIANGLE DRAWN AT EQUAL DEPTH, SO THE CHANGED ORDER CAN CHANGE SEAM CELLS WHERE
+// FACES MEET, A SESSION RECORDING STORES THE SETTING SO ITS REPLAY RENDERS THE SAME FRAMES
+bool depth_rejection();
+void set_depth_rejection(bool enabled);
+
+// EDGE FUNCTION TRIANGLE FILL (TOP-LEFT RULE, WATERTIGHT ACROSS SHARED EDGES) LIMITED TO clip
+// EVERY CELL GETS THE SAME DEPTH NO MATTER HOW THE SCREEN IS SPLIT, SO TILED OUTPUT MATCHES A SINGLE PASS
+void fill_triangle(const ScreenTriangle& triangle, const TileRect& clip, Framebuffer& screen, ZBuffer& zbuffer, RasterCounts& counts);
@@ -0,0 +1,308 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include "Recording.hpp"
+#include "Output.hpp"
+#include "Pacing.hpp"
+
+static const char SESSION_MAGIC[4] = {'R', 'R', 'S', 'N'};
+
+void apply_event(Session& session, const SessionEvent& event) {
+	if (event.type == EVENT_MOVE) session.queue_move(event.move);
+	if (event.type == EVENT_SOLVE) session.queue_solution(event.moves);
+	if (event.type == EVENT_CAMERA) session.camera_impulse(event.yaw_steps, event.pitch_steps);
+}
+
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+uint64_t frame_hash(const Framebuffer& frame) {
+	uint64_t hash = 14695981039346656037ull;
+	hash = hash_bytes(hash, &frame.width, sizeof(frame.width));
+	hash = hash_bytes(hash, &frame.height, sizeof(frame.height));
+	return hash_bytes(hash, frame.cells.data(), frame.cells.size() * sizeof(Cell));
+}
+
+static void put_varint(std::string& out, uint64_t value) {
+	while (value >= 0x80) {
+		out += (char)((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	out += (char)value;
+}
+
+static void put_signed(std::string& out, int64_t value) {
+	put_varint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static uint8_t pack_move(const Move& move) {
+	return (uint8_t)(move.face | (move.quarters - 1) << 3 | (move.depth + 1) << 5);
+}
+
+bool SessionRecorder::open(const std::string& path) {
+	out.open(path, std::ios::binary | std::ios::trunc);
+	if (!out) return false;
+	out.write(SESSION_MAGIC, sizeof(SESSION_MAGIC));
+	out.put((char)SESSION_FORMAT_VERSION);
+	out.put((char)CUBE_N);
+	last_tick = 0;
+	return (bool)out;
+}
+
+void SessionRecorder::write(const SessionEvent& event) {
+	if (!out.is_open()) return;
+	buffer.clear();
+	put_varint(buffer, (event.tick - last_tick) << 3 | event.type);
+	last_tick = event.tick;
+
+	switch (event.type) {
+		case EVENT_RESIZE:
+			put_varint(buffer, event.width);
+			put_varint(buffer, event.height);
+			put_varint(buffer, (uint64_t)event.cell_mode);
+			put_varint(buffer, event.depth_rejection ? 1 : 0);
+			break;
+		case EVENT_MOVE:
+			buffer += (char)pack_move(event.move);
+			break;
+		case EVENT_SOLVE:
+			put_varint(buffer, event.moves.size());
+			for (const Move& move : event.moves) buffer += (char)pack_move(move);
+			break;
+		case EVENT_CAMERA:
+			put_signed(buffer, event.yaw_steps);
+			put_signed(buffer, event.pitch_steps);
+			break;
+		case EVENT_FRAME:
+			for (int i = 0; i < 8; i++) buffer += (char)(event.hash >> (8 * i));
+			break;
+	}
+	out.write(buffer.data(), buffer.size());
+}
+
+bool SessionRecorder::close() {
+	if (!out.is_open()) return true;
+	out.close();
+	return !out.fail();
+}
+
+bool SessionReader::open(const std::string& path, std::string& error) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		error = "could not open " + path;
+		return false;
+	}
+	data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	if (data.size() < 6 || std::memcmp(data.data(), SESSION_MAGIC, sizeof(SESSION_MAGIC)) != 0) {
+		error = path + " is not a session recording";
+		return false;
+	}
+	if (data[4] < 1 || data[4] > SESSION_FORMAT_VERSION) {
+		error = path + " has unsupported format version " + std::to_string(data[4]);
+		return false;
+	}
+	if (data[5] != CUBE_N) {
+		error = path + " was recorded on a " + std::to_string(data[5]) + "x" + std::to_string(data[5]) + "x"
+			+ std::to_string(data[5]) + " cube, this build is " + std::to_string(CUBE_N) + "x" + std::to_string(CUBE_N)
+			+ "x" + std::to_string(CUBE_N);
+		return false;
+	}
+	version = data[4];
+	at = 6;
+	tick = 0;
+	corrupt = false;
+	return true;
+}
+
+bool SessionReader::next(SessionEvent& event) {
+	if (at >= data.size()) return false;
+
+	// EVERY READ BELOW CHECKS THE END OF THE DATA, A TRUNCATED EVENT MARKS THE RECORDING CORRUPT
+	auto get_varint = [&](uint64_t& value) {
+		value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (at >= data.size()) return false;
+			uint8_t byte = data[at++];
+			value |= (uint64_t)(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) return true;
+		}
+		return false;
+	};
+	auto get_signed = [&](int& value) {
+		uint64_t zigzag;
+		if (!get_varint(zigzag)) return false;
+		value = (int)((int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1));
+		return true;
+	};
+	auto get_move = [&](Move& move) {
+		if (at >= data.size()) return false;
+		uint8_t byte = data[at++];
+		move.face = byte & 7;
+		move.quarters = (byte >> 3 & 3) + 1;
+		move.depth = (int8_t)((byte >> 5) - 1);
+		return move.face < 6 && move.quarters <= 3 && move.depth < TURN_DEPTHS;
+	};
+
+	uint64_t head;
+	bool ok = get_varint(head);
+	if (ok) {
+		tick += head >> 3;
+		event.tick = tick;
+		event.type = (SessionEventType)(head & 7);
+		uint64_t a = 0, b = 0;
+		switch (event.type) {
+			case EVENT_RESIZE:
+				ok = get_varint(a) && get_varint(b) && a > 0 && b > 0 && a <= 10000 && b <= 10000;
+				event.width = (int)a;
+				event.height = (int)b;
+				event.cell_mode = CellMode::Full;
+				if (ok && version >= 2) {
+					uint64_t mode = 0;
+					ok = get_varint(mode) && mode <= (uint64_t)CellMode::Quad;
+					event.cell_mode = (CellMode)mode;
+				}
+				event.depth_rejection = false;
+				if (ok && version >= 3) {
+					uint64_t rejection = 0;
+					ok = get_varint(rejection) && rejection <= 1;
+					event.depth_rejection = rejection == 1;
+				}
+				break;
+			case EVENT_MOVE:
+				ok = get_move(event.move);
+				break;
+			case EVENT_SOLVE:
+				ok = get_varint(a) && a <= data.size() - at;
+				event.moves.resize(ok ? a : 0);
+				for (Move& move : event.moves) ok = ok && get_move(move);
+				break;
+			case EVENT_CAMERA:
+				ok = get_signed(event.yaw_steps) && get_signed(event.pitch_steps);
+				break;
+			case EVENT_FRAME:
+				ok = at + 8 <= data.size();
+				event.hash = 0;
+				for (int i = 0; ok && i < 8; i++) event.hash |= (uint64_t)data[at++] << (8 * i);
+				break;
+			default:
+				ok = false;
+		}
+	}
+	if (!ok) {
+		corrupt = true;
+		at = data.size();
+	}
+	return ok;
+}
+
+int run_replay(int argc, char** argv) {
+	std::string path;
+	int threads = 1;
+	OutputMode mode = OutputMode::Ansi16;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			path = argv[++i];
+		} else if (std::strcmp(argv[i], "--max") == 0) {
+			// THE ONLY SPEED THIS RUNS AT, main ONLY HANDS --replay OVER WHEN --max IS GIVEN
+			continue;
+		} else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			if (!parse_output_mode(name, mode)) {
+				std::cerr << "unknown --output " << name << " (expected ftxui, ansi16, ansi256, truecolor or ppm)\n";
+				return 1;
+			}
+		}
+	}
+	if (threads <= 0) {
+		std::cerr << "--threads must be positive\n";
+		return 1;
+	}
+
+	SessionReader reader;
+	std::string error;
+	if (!reader.open(path, error)) {
+		std::cerr << error << "\n";
+		return 1;
+	}
+
+	using Clock = std::chrono::steady_clock;
+	auto seconds = [](Clock::time_point a, Clock::time_point b) {
+		return std::chrono::duration<double>(b - a).count();
+	};
+
+	Session session;
+	FrameContext frame;
+	frame.tiles.set_threads(threads);
+	std::unique_ptr<FrameEncoder> encoder = make_encoder(mode);
+
+	long events = 0;
+	long frames = 0;
+	long mismatches = 0;
+	uint64_t first_mismatch = 0;
+	size_t bytes = 0;
+	double simulate = 0.0, render = 0.0, encode = 0.0;
+	auto start = Clock::now();
+
+	SessionEvent event;
+	while (reader.next(event)) {
+		events++;
+
+		// STEP UP TO THE TICK THE EVENT HAPPENED ON
+		auto t0 = Clock::now();
+		while (session.ticks < event.tick) session.step();
+		auto t1 = Clock::now();
+		simulate += seconds(t0, t1);
+
+		if (event.type == EVENT_RESIZE) {
+			frame.cell_mode = event.cell_mode;
+			set_depth_rejection(event.depth_rejection);
+			frame.resize(event.width, event.height);
+		} else if (event.type == EVENT_FRAME) {
+			if (frame.screen.width == 0) continue;
+			render_cube(session.cube, frame, camera_projection(frame.screen.width, frame.screen.height),
+				camera_view(session.pitch, session.yaw));
+			uint64_t hash = frame_hash(frame.screen);
+			auto t2 = Clock::now();
+			bytes += encoder->encode(frame.screen).size();
+			auto t3 = Clock::now();
+			render += seconds(t1, t2);
+			encode += seconds(t2, t3);
+
+			if (hash != event.hash && mismatches++ == 0) first_mismatch = event.tick;
+			frames++;
+		} else {
+			apply_event(session, event);
+		}
+	}
+	double total = seconds(start, Clock::now());
+
+	if (reader.corrupt) {
+		std::cerr << path << " is truncated or corrupt after " << events << " events, replayed up to there\n";
+	}
+	double frame_ms = frames > 0 ? 1000.0 / frames : 0.0;
+	std::printf("replayed %ld events, %llu ticks (%.1f s of session), %ld frames in %.3f s (%.0f fps)\n",
+			events, (unsigned long long)session.ticks, session.ticks * SIM_STEP, frames, total,
+			total > 0.0 ? frames / total : 0.0);
+	std::printf("per frame: simulate %.4f ms, render %.4f ms, encode (%s) %.4f ms, %.2f kB\n",
+			simulate * frame_ms, render * frame_ms, output_mode_name(mode), encode * frame_ms,
+			frames > 0 ? bytes / 1024.0 / frames : 0.0);
+	std::printf("moves: %s\n", session.move_list.letters.c_str());
+	if (mismatches > 0) {
+		std::printf("%ld frames differ from the recording, the first at tick %llu\n", mismatches,
+				(unsigned long long)first_mismatch);
+		return 1;
+	}
+	std::printf("every frame matches the recording\n");
+	return reader.corrupt ? 1 : 0;
+}
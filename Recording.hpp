@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Framebuffer.hpp"
+#include "Session.hpp"
+#include "SubCell.hpp"
+
+// SESSION RECORDING: A HEADER ("RRSN", FORMAT VERSION, CUBE_N) FOLLOWED BY EVENTS, EACH ONE
+//   VARINT (TICKS SINCE THE PREVIOUS EVENT << 3 | TYPE), THEN THE PAYLOAD OF ITS TYPE
+// VARINTS ARE LEB128 (7 BITS PER BYTE, LOW BITS FIRST), SIGNED ONES ZIGZAG ENCODED
+// A MOVE IS ONE BYTE: FACE | (QUARTERS - 1) << 3 | (DEPTH + 1) << 5
+enum SessionEventType : uint8_t {
+	EVENT_RESIZE = 0, // VARINT WIDTH, VARINT HEIGHT, VARINT CellMode (VERSION 2, VERSION 1 WAS ALWAYS FULL),
+	                  // VARINT 1 WITH DEPTH REJECTION (VERSION 3, IT CAN SETTLE EQUAL DEPTH TIES DIFFERENTLY)
+	EVENT_MOVE = 1,   // MOVE
+	EVENT_SOLVE = 2,  // VARINT COUNT, COUNT MOVES
+	EVENT_CAMERA = 3, // SIGNED VARINT YAW KEY PRESSES, SIGNED VARINT PITCH KEY PRESSES
+	EVENT_FRAME = 4,  // 8 BYTE LITTLE ENDIAN HASH OF THE RENDERED CUBE (frame_hash)
+};
+
+constexpr uint8_t SESSION_FORMAT_VERSION = 3;
+
+// ONE RECORDED EVENT, ONLY THE FIELDS OF ITS TYPE ARE USED
+struct SessionEvent {
+	uint64_t tick = 0;
+	SessionEventType type = EVENT_MOVE;
+	Move move;
+	std::vector<Move> moves;
+	int yaw_steps = 0;
+	int pitch_steps = 0;
+	int width = 0;
+	int height = 0;
+	CellMode cell_mode = CellMode::Full;
+	bool depth_rejection = false;
+	uint64_t hash = 0;
+};
+
+// APPLIES AN INPUT EVENT (MOVE, SOLVE OR CAMERA) TO THE SESSION, RESIZES AND FRAMES DO NOT CHANGE THE SIMULATION
+void apply_event(Session& session, const SessionEvent& event);
+
+// FNV-1a OVER RAW BYTES
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t size);
+
+// HASH OF THE CELLS OF A FRAME (TAKEN BEFORE THE OVERLAYS ARE DRAWN, THEY SHOW WALL CLOCK NUMBERS)
+uint64_t frame_hash(const Framebuffer& frame);
+
+// APPENDS EVENTS TO A FILE, THEY MUST COME IN TICK ORDER
+struct SessionRecorder {
+	std::ofstream out;
+	uint64_t last_tick = 0;
+	std::string buffer;
+
+	bool open(const std::string& path);
+	void write(const SessionEvent& event);
+
+	// FALSE IF ANYTHING FAILED TO WRITE
+	bool close();
+};
+
+// READS A WHOLE RECORDING INTO MEMORY AND HANDS OUT ITS EVENTS IN ORDER
+struct SessionReader {
+	std::vector<uint8_t> data;
+	size_t at = 0;
+	uint64_t tick = 0;
+	uint8_t version = 0;
+
+	// SET WHEN next STOPPED ON A TRUNCATED OR INVALID EVENT INSTEAD OF THE END OF THE FILE
+	bool corrupt = false;
+
+	// FALSE (WITH error SET) IF THE FILE CANNOT BE READ OR IS NOT A RECORDING OF THIS CUBE SIZE
+	bool open(const std::string& path, std::string& error);
+
+	// FALSE AT THE END OF THE RECORDING
+	bool next(SessionEvent& event);
+};
+
+// HEADLESS REPLAY AT MAXIMUM SPEED: RUNS THE SIMULATION, RENDERS AND ENCODES EVERY RECORDED FRAME AND CHECKS
+// ITS HASH, THEN PRINTS TIMINGS (EXIT CODE 1 IF ANY FRAME DIFFERS)
+// USAGE: RubiksRays --replay FILE --max [--threads N] [--output ftxui|ansi16|ansi256|truecolor|ppm]
+// (THE SUB-CELL MODE AND --hiz COME FROM THE RECORDING)
+int run_replay(int argc, char** argv);
@@ -0,0 +1,549 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include "Render.hpp"
+#include "Profile.hpp"
+
+RenderStats render_stats;
+
+// ONLY REALLOCATES THE SCREEN, SAMPLES AND ZBUFFER WHEN THE SIZE CHANGES
+bool FrameContext::resize(int width, int height) {
+	if (cell_mode != CellMode::Full) subcells.resize(width * cell_columns(cell_mode), height * cell_rows(cell_mode));
+	if (width == screen.width && height == screen.height) return false;
+	screen.resize(width, height);
+	zbuffer.resize(canvas().width, canvas().height);
+	return true;
+}
+
+// CONSTRUCTS PLANE FROM NORMAL
+Plane MakePlane(glm::vec3 normal, uint8_t color, bool invert_normal) {
+	glm::vec3 p0 = {-0.5f, -0.5f, 0.0f};
+	glm::vec3 p1 = { 0.5f, -0.5f, 0.0f};
+	glm::vec3 p2 = { 0.5f,  0.5f, 0.0f};
+	glm::vec3 p3 = {-0.5f,  0.5f, 0.0f};
+
+	Triangle tri1 = {{p0, p1, p2}, color};
+	if (invert_normal)
+		tri1 = {{p2, p1, p0}, color};
+	Triangle tri2 = {{p2, p3, p0}, color};
+	if (invert_normal)
+		tri2 = {{p0, p3, p2}, color};
+
+	glm::vec3 axis = glm::cross(glm::vec3(0, 0, 1), normal);
+	float angle = acos(glm::dot(glm::normalize(normal), glm::vec3(0, 0, 1)));
+
+	glm::mat4 rotation = glm::mat4(1.0f);
+	if (glm::length(axis) > 0.001f)
+		rotation = glm::rotate(glm::mat4(1.0f), angle, glm::normalize(axis));
+
+	return Plane{tri1, tri2, normal * 0.5f, rotation};
+}
+
+// SPACE BETWEEN CUBE UNITS
+const float cube_padding = 0.4f;
+
+// STICKER COLORS INDEXED BY Face (U, R, F, D, L, B)
+const uint8_t face_colors[6] = {
+	COLOR_YELLOW_LIGHT, COLOR_GREEN, COLOR_RED,
+	COLOR_WHITE, COLOR_BLUE, COLOR_RED_LIGHT,
+};
+
+// OUTWARD NORMALS OF THE PLANES BUILT BY MakeUnitPlanes (FRONT, BACK, LEFT, RIGHT, TOP, BOTTOM)
+const Vec3i plane_normals[6] = {
+	{0, 0, 1}, {0, 0, -1}, {-1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, -1, 0},
+};
+
+// WORLD POSITION OF A GRID SLOT, THE CUBE IS CENTERED ON THE ORIGIN
+glm::vec3 unit_position(Vec3i g) {
+	float center = (CUBE_N - 1) * 0.5f;
+	return (cube_padding + 1.0f) * glm::vec3((float)g.x - center, (float)g.y - center, (float)g.z - center);
+}
+
+// CONSTRUCTS THE PLANES OF THE CUBE UNIT IN GRID SLOT grid, FACES ON THE OUTSIDE OF THE CUBE GET THEIR SOLVED COLOR
+std::array<Plane, 6> MakeUnitPlanes(Vec3i grid) {
+	float padding = 0.2f;
+	const int last = CUBE_N - 1;
+	std::array<Plane, 6> faces = {
+		MakePlane({ 0,  0,  1 + padding}, grid.z < last ? COLOR_BLACK : COLOR_RED, true),    // Front
+		MakePlane({ 0,  0, -1 - padding}, grid.z > 0 ? COLOR_BLACK : COLOR_RED_LIGHT, false), // Back
+		MakePlane({-1 - padding,  0,  0}, grid.x > 0 ? COLOR_BLACK : COLOR_BLUE, true),   // Left
+		MakePlane({ 1 + padding,  0,  0}, grid.x < last ? COLOR_BLACK : COLOR_GREEN, true),  // Right
+		MakePlane({ 0,  1 + padding,  0}, grid.y < last ? COLOR_BLACK : COLOR_YELLOW_LIGHT, true),  // Top
+		MakePlane({ 0, -1 - padding,  0}, grid.y > 0 ? COLOR_BLACK : COLOR_WHITE, true), // Bottom
+	};
+	return faces;
+}
+
+// FLATTENS THE PLANES OF EVERY CUBE UNIT INTO ONE MESH, PLANE TRANSFORMS ARE BAKED INTO THE VERTICES
+static CubeMesh compile_mesh() {
+	CubeMesh mesh;
+
+	// UNIT IN EACH GRID SLOT, HOLLOW_NEIGHBOUR INSIDE THE SHELL
+	std::array<int16_t, CUBE_N * CUBE_N * CUBE_N> slot_unit;
+	slot_unit.fill(HOLLOW_NEIGHBOUR);
+	for (int u = 0; u < SHELL_UNITS; u++) {
+		Vec3i g = unit_grid(u);
+		slot_unit[g.x + g.y * CUBE_N + g.z * CUBE_N * CUBE_N] = (int16_t)u;
+	}
+
+	for (int u = 0; u < SHELL_UNITS; u++) {
+		Vec3i g = unit_grid(u);
+		std::array<Plane, 6> planes = MakeUnitPlanes(g);
+		for (int p = 0; p < 6; p++) {
+			const Plane& plane = planes[p];
+			int face = u * 6 + p;
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), plane.position) * plane.rotation;
+			for (const Triangle* tri : {&plane.tri1, &plane.tri2}) {
+				for (int i = 0; i < 3; i++) {
+					glm::vec3 v = glm::vec3(model * glm::vec4(tri->points[i], 1.0f));
+					mesh.x.push_back(v.x);
+					mesh.y.push_back(v.y);
+					mesh.z.push_back(v.z);
+					mesh.extent = std::max(mesh.extent, std::abs(unit_position(g).x + v.x));
+				}
+			}
+
+			// PLANES SIT ON THEIR OUTWARD NORMAL, THE NEIGHBOUR IS ONE GRID SLOT THAT WAY
+			glm::vec3 normal = glm::normalize(plane.position);
+			int nx = g.x + (int)std::lround(normal.x);
+			int ny = g.y + (int)std::lround(normal.y);
+			int nz = g.z + (int)std::lround(normal.z);
+			bool inside = nx >= 0 && nx < CUBE_N && ny >= 0 && ny < CUBE_N && nz >= 0 && nz < CUBE_N;
+
+			// THE PADDING LEAVES A GAP BETWEEN NEIGHBOURS, ITS WALLS SHOW THROUGH THE GRID LINES OF EVERY
+			// CUBE SIDE THE UNIT SITS ON THAT IS PERPENDICULAR TO THE FACE (BIT axis * 2 + (ON THE POSITIVE SIDE))
+			const int last = CUBE_N - 1;
+			uint8_t sides = 0;
+			if (std::lround(normal.x) == 0) {
+				if (g.x == 0) sides |= 1 << 0;
+				if (g.x == last) sides |= 1 << 1;
+			}
+			if (std::lround(normal.y) == 0) {
+				if (g.y == 0) sides |= 1 << 2;
+				if (g.y == last) sides |= 1 << 3;
+			}
+			if (std::lround(normal.z) == 0) {
+				if (g.z == 0) sides |= 1 << 4;
+				if (g.z == last) sides |= 1 << 5;
+			}
+
+			mesh.face_normal[face] = normal;
+			mesh.face_center[face] = plane.position;
+			mesh.face_neighbour[face] = inside ? slot_unit[nx + ny * CUBE_N + nz * CUBE_N * CUBE_N] : (int16_t)-1;
+			mesh.face_gap_sides[face] = sides;
+			mesh.face_sticker[face] = (int16_t)sticker_at(g.x, g.y, g.z, plane_normals[p].x, plane_normals[p].y, plane_normals[p].z);
+		}
+	}
+
+	// ONE QUAD PER SIDE OF THE WHOLE CUBE (THE UNIT PLANE SCALED UP, SAME WINDING AS THE UNIT FACES) AND THE FACES
+	// IT TAKES ITS COLOR FROM
+	static const bool invert[6] = {true, false, true, true, true, true};
+	for (int p = 0; p < 6; p++) {
+		Vec3i n = plane_normals[p];
+		Plane plane = MakePlane(glm::vec3((float)n.x, (float)n.y, (float)n.z), COLOR_BLACK, invert[p]);
+		glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f * mesh.extent)) * glm::translate(glm::mat4(1.0f), plane.position) * plane.rotation;
+		for (const Triangle* tri : {&plane.tri1, &plane.tri2}) {
+			for (int i = 0; i < 3; i++) {
+				glm::vec3 v = glm::vec3(model * glm::vec4(tri->points[i], 1.0f));
+				mesh.side_x.push_back(v.x);
+				mesh.side_y.push_back(v.y);
+				mesh.side_z.push_back(v.z);
+			}
+		}
+
+		// THE OUTSIDE FACES OF PLANE p ARE EXACTLY THE STICKERS OF THAT SIDE
+		int count = 0;
+		for (int u = 0; u < SHELL_UNITS; u++) {
+			if (mesh.face_sticker[u * 6 + p] >= 0) mesh.side_faces[p][count++] = (int16_t)(u * 6 + p);
+		}
+	}
+	return mesh;
+}
+
+const CubeMesh& cube_mesh() {
+	static const CubeMesh mesh = compile_mesh();
+	return mesh;
+}
+
+// CLIP SPACE TO CONTINUOUS CELL COORDINATES (BEFORE THE DIVIDE BY w), THE RASTERIZER SAMPLES CELL CENTERS
+static glm::mat4 cell_viewport(const Framebuffer& screen) {
+	glm::mat4 viewport(1.0f);
+	viewport[0][0] = 0.5f * screen.width;
+	viewport[1][1] = -0.5f * screen.height;
+	viewport[3][0] = 0.5f * screen.width;
+	viewport[3][1] = 0.5f * screen.height;
+	return viewport;
+}
+
+// PICKS THE FACES THAT CAN BE SEEN THIS FRAME, THEN TRANSFORMS ONLY THEIR VERTICES STRAIGHT TO CELL COORDINATES
+// (ONE MATRIX PER CUBE UNIT) AND QUEUES THE FRONT FACING TRIANGLES, NEAREST FACE FIRST WITH depth_rejection
+void project_mesh(const Cube& cube, FrameContext& frame, const glm::mat4& proj, const glm::mat4& view, UnitSet units) {
+	const CubeMesh& mesh = cube_mesh();
+
+	// EVERYTHING BELOW WORKS IN CUBE SPACE, THE MODEL MATRIX IS FOLDED INTO THE VIEW
+	glm::mat4 model_view = view * cube.model;
+	glm::mat4 view_proj = cell_viewport(frame.canvas()) * proj * model_view;
+	glm::vec3 camera = glm::vec3(glm::inverse(model_view)[3]);
+
+	// CUBE SIDES THE CAMERA IS IN FRONT OF (SAME BITS AS face_gap_sides)
+	uint8_t camera_sides = 0;
+	for (int axis = 0; axis < 3; axis++) {
+		camera_sides |= 1 << (axis * 2 + (camera[axis] > 0.0f));
+	}
+
+	// THE HOLLOW INSIDE ONLY SHOWS WHILE A SLICE TURN SPLITS THE CUBE, NOT WHILE IT RESTS OR ROTATES AS A WHOLE
+	// (A STATIC OR MOVING SUBSET MAY OUTLIVE THE CURRENT POSES IN THE STATIC LAYER, SO IT IS NEVER TREATED AS RIGID)
+	bool rigid = units == UnitSet::All;
+	for (int u = 1; u < SHELL_UNITS && rigid; u++) {
+		rigid = cube.units[u].rotation == cube.units[0].rotation;
+	}
+
+	// VISIBILITY PRE-PASS, A CUBE UNIT LEFT WITHOUT VISIBLE FACES IS SKIPPED ENTIRELY
+	glm::mat4 mvp[SHELL_UNITS];
+	frame.face_order.clear();
+	for (int u = 0; u < SHELL_UNITS; u++) {
+		if (units != UnitSet::All && (cube.moving[u] != 0) != (units == UnitSet::Moving)) continue;
+		const CubeUnit& unit = cube.units[u];
+		glm::mat3 rotation = glm::mat3(unit.rotation);
+		size_t first = frame.face_order.size();
+		for (int p = 0; p < 6; p++) {
+			int face = u * 6 + p;
+
+			// A FACE ACROSS FROM A NEIGHBOUR IS HIDDEN UNLESS A SLICE TURN SEPARATES THEM (UNITS OF THE SAME SLICE
+			// ALWAYS SHARE AN IDENTICAL ROTATION MATRIX) OR ITS GAP OPENS ONTO A SIDE FACING THE CAMERA
+			// FACES AGAINST A UNIT OF THE OTHER SUBSET ARE ALWAYS KEPT FOR THE SAME REASON
+			int neighbour = mesh.face_neighbour[face];
+			bool same_subset = units == UnitSet::All || (neighbour >= 0 && cube.moving[neighbour] == cube.moving[u]);
+			if (neighbour >= 0 && same_subset && cube.units[neighbour].rotation == unit.rotation && !(mesh.face_gap_sides[face] & camera_sides)) continue;
+			if (neighbour == HOLLOW_NEIGHBOUR && rigid) continue;
+
+			// BACKFACE CULLING BY FACE NORMAL
+			glm::vec3 normal = rotation * mesh.face_normal[face];
+			glm::vec3 center = unit.position + rotation * mesh.face_center[face];
+			glm::vec3 to_camera = camera - center;
+			if (glm::dot(normal, to_camera) <= 0.0f) continue;
+
+			frame.face_order.push_back({glm::dot(to_camera, to_camera), (uint32_t)face});
+		}
+		if (frame.face_order.size() == first) continue;
+		mvp[u] = view_proj * glm::translate(glm::mat4(1.0f), unit.position) * unit.rotation;
+	}
+
+	// FRONT TO BACK BY FACE CENTER, SO FACES HIDDEN BEHIND NEARER ONES FAIL THE COARSE DEPTH TEST AS A WHOLE
+	// (THE ZBUFFER KEEPS THE FIRST OF TWO FACES AT EQUAL DEPTH, SO SEAM CELLS CAN COME OUT DIFFERENTLY IN THIS ORDER,
+	// RECORDINGS STORE depth_rejection SO REPLAYS MATCH)
+	if (depth_rejection()) std::sort(frame.face_order.begin(), frame.face_order.end());
+	frame.visible_faces.clear();
+	for (const DrawOrder& order : frame.face_order) frame.visible_faces.push_back((uint16_t)order.index);
+
+	// BATCHED VERTEX PASS OVER THE VISIBLE FACES
+	frame.screen_x.resize(mesh.x.size());
+	frame.screen_y.resize(mesh.x.size());
+	frame.screen_z.resize(mesh.x.size());
+	for (uint16_t face : frame.visible_faces) {
+		const glm::mat4& m = mvp[face / 6];
+		size_t base = (size_t)face * 6;
+		for (size_t i = base; i < base + 6; i++) {
+			float x = mesh.x[i];
+			float y = mesh.y[i];
+			float z = mesh.z[i];
+			float w = 1.0f / (m[0][3] * x + m[1][3] * y + m[2][3] * z + m[3][3]);
+			frame.screen_x[i] = (m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0]) * w;
+			frame.screen_y[i] = (m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1]) * w;
+			frame.screen_z[i] = (m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2]) * w;
+		}
+	}
+
+	// THE PROJECTED WINDING HAS THE FINAL SAY FOR FACES SEEN EDGE ON (THE CAMERA NEVER GETS CLOSE ENOUGH FOR w TO REACH 0)
+	for (uint16_t face : frame.visible_faces) {
+		size_t base = (size_t)face * 6;
+		for (size_t i = base; i < base + 6; i += 3) {
+			glm::vec3 v0 = {frame.screen_x[i], frame.screen_y[i], frame.screen_z[i]};
+			glm::vec3 v1 = {frame.screen_x[i + 1], frame.screen_y[i + 1], frame.screen_z[i + 1]};
+			glm::vec3 v2 = {frame.screen_x[i + 2], frame.screen_y[i + 2], frame.screen_z[i + 2]};
+			float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+			if (area <= 0.0f) continue;
+			frame.triangles.push_back({{v0, v1, v2}, cube.face_color[face]});
+		}
+	}
+}
+
+bool StaticLayer::matches(const Cube& cube, const glm::mat4& view, const glm::mat4& proj, int width, int height) const {
+	return valid && this->width == width && this->height == height && revision == cube.revision && moving == cube.moving
+		&& this->view == view && this->proj == proj;
+}
+
+// RASTERIZES frame.triangles ON frame.tiles, TIMED FOR THE PROFILER OR --bench
+static void rasterize_triangles(FrameContext& frame) {
+	if (!render_stats.enabled) {
+		ScopedTimer timer(STAGE_RASTER);
+		frame.tiles.rasterize(frame.triangles, frame.canvas(), frame.zbuffer, frame.counts);
+		return;
+	}
+
+	auto raster_start = std::chrono::steady_clock::now();
+	frame.tiles.rasterize(frame.triangles, frame.canvas(), frame.zbuffer, frame.counts);
+	render_stats.raster_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - raster_start).count();
+	render_stats.triangles += (long)frame.triangles.size();
+}
+
+// TURNS THE SAMPLES OF A SUB-CELL MODE INTO frame.screen, TIMED WITH THE RASTER STAGE FOR THE PROFILER
+static void resolve_canvas(FrameContext& frame) {
+	if (frame.cell_mode == CellMode::Full) return;
+	if (!render_stats.enabled) {
+		ScopedTimer timer(STAGE_RASTER);
+		resolve_subcells(frame.subcells, frame.cell_mode, frame.screen);
+		return;
+	}
+
+	auto resolve_start = std::chrono::steady_clock::now();
+	resolve_subcells(frame.subcells, frame.cell_mode, frame.screen);
+	render_stats.resolve_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - resolve_start).count();
+}
+
+// PROJECTS units AND RASTERIZES THEM OVER WHAT THE SCREEN AND ZBUFFER ALREADY HOLD
+static void draw_units(const Cube& cube, FrameContext& frame, const glm::mat4& proj, const glm::mat4& view, UnitSet units) {
+	frame.triangles.clear();
+	{
+		ScopedTimer timer(STAGE_PROJECT);
+		project_mesh(cube, frame, proj, view, units);
+	}
+	rasterize_triangles(frame);
+}
+
+// CLEARS SCREEN AND ZBUFFER, PROJECTS EVERY CUBE UNIT THEN RASTERIZES THE FRAME ON frame.tiles
+// DURING A TURN WITH A STILL CAMERA THE UNITS THAT DO NOT MOVE COME FROM frame.static_layer INSTEAD
+static void draw_cube(const Cube& cube, FrameContext& frame, const glm::mat4& proj, const glm::mat4& view) {
+	Framebuffer& screen = frame.canvas();
+	int width = screen.width;
+	int height = screen.height;
+	frame.zbuffer.resize(width, height);
+	frame.counts = RasterCounts{};
+
+	// THE LAYER ONLY PAYS OFF ONCE A TURN SPLITS THE CUBE: SOME UNITS STAY PUT AND SOME ALREADY LEFT THEIR POSE
+	// A POSE IS A GRID SLOT PLUS ONE OF THE 24 ORIENTATIONS, THE LAYER IS KEYED ON cube.revision AND cube.moving:
+	// UNITS OUTSIDE moving KEEP THE SLOT AND ORIENTATION sync_cube GAVE THEM UNTIL THE NEXT sync_cube BUMPS THE
+	// REVISION, A MOVING UNIT HAS LEFT ITS POSE ONCE ITS ROTATION IS NOT THE IDENTITY (IN FLIGHT, OR LANDED IN ANOTHER
+	// ORIENTATION WHILE TURNS ON ITS AXIS ARE STILL RUNNING)
+	bool moved = false;
+	bool resting = false;
+	for (int u = 0; u < SHELL_UNITS; u++) {
+		if (!cube.moving[u]) resting = true;
+		else if (!moved) moved = !(cube.units[u].rotation == glm::mat4(1.0f));
+	}
+	bool turning = moved && resting;
+	bool camera_still = view == frame.last_view && proj == frame.last_proj;
+	frame.last_view = view;
+	frame.last_proj = proj;
+
+	StaticLayer& layer = frame.static_layer;
+	bool reuse = turning && layer.matches(cube, view, proj, width, height);
+
+	// REUSE: THE STATIC UNITS ARE COPIED BACK INTO THE SCREEN AND ZBUFFER (WHICH ALSO CLEARS EVERYTHING ELSE)
+	if (reuse) {
+		std::copy(layer.depth.begin(), layer.depth.end(), frame.zbuffer.depth.begin());
+		frame.zbuffer.invalidate_coarse();
+		std::copy(layer.cells.begin(), layer.cells.end(), screen.cells.begin());
+		draw_units(cube, frame, proj, view, UnitSet::Moving);
+		return;
+	}
+
+	// CLEAR SCREEN AND ZBUFFER (THE SCREEN IS REUSED ACROSS FRAMES SO OVERLAYS MUST BE CLEARED TOO)
+	frame.zbuffer.clear();
+	screen.clear();
+
+	// A STILL CAMERA DURING A TURN BUILDS THE STATIC LAYER FIRST, THEN DRAWS THE TURNING UNITS OVER IT
+	// (A MOVING CAMERA WOULD THROW IT AWAY NEXT FRAME, SO IT DRAWS EVERYTHING IN ONE PASS)
+	if (turning && camera_still) {
+		draw_units(cube, frame, proj, view, UnitSet::Static);
+
+		layer.valid = true;
+		layer.view = view;
+		layer.proj = proj;
+		layer.width = width;
+		layer.height = height;
+		layer.revision = cube.revision;
+		layer.moving = cube.moving;
+		layer.depth.assign(frame.zbuffer.depth.begin(), frame.zbuffer.depth.end());
+		layer.cells.assign(screen.cells.begin(), screen.cells.end());
+
+		draw_units(cube, frame, proj, view, UnitSet::Moving);
+		return;
+	}
+
+	draw_units(cube, frame, proj, view, UnitSet::All);
+}
+
+void render_cube(const Cube& cube, FrameContext& frame, const glm::mat4& proj, const glm::mat4& view) {
+	draw_cube(cube, frame, proj, view);
+	resolve_canvas(frame);
+}
+
+// QUEUES THE FRONT FACING SIDES OF THE LEVEL OF DETAIL QUAD MESH (UNIT POSES ARE IGNORED, A TURNING SLICE IS
+// NOT VISIBLE AT THIS SIZE ANYWAY)
+static void project_sides(const Cube& cube, FrameContext& frame, const glm::mat4& viewport_proj_view) {
+	const CubeMesh& mesh = cube_mesh();
+	glm::mat4 m = viewport_proj_view * cube.model;
+	for (int side = 0; side < 6; side++) {
+		glm::vec3 v[6];
+		for (int i = 0; i < 6; i++) {
+			float x = mesh.side_x[side * 6 + i];
+			float y = mesh.side_y[side * 6 + i];
+			float z = mesh.side_z[side * 6 + i];
+			float w = 1.0f / (m[0][3] * x + m[1][3] * y + m[2][3] * z + m[3][3]);
+			v[i].x = (m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0]) * w;
+			v[i].y = (m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1]) * w;
+			v[i].z = (m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2]) * w;
+		}
+
+		// MOST COMMON COLOR ON THE SIDE, THE FIRST ONE FOUND WINS A TIE (A CENTER STICKER NEVER MOVES ON A FACE TURN,
+		// SO IT WOULD SHOW EVERY CUBE AS SOLVED)
+		uint8_t count[256] = {};
+		uint8_t color = COLOR_BLACK;
+		for (int16_t face : mesh.side_faces[side]) {
+			uint8_t c = cube.face_color[face];
+			if (++count[c] > count[color]) color = c;
+		}
+		for (int i = 0; i < 6; i += 3) {
+			float area = (v[i + 1].x - v[i].x) * (v[i + 2].y - v[i].y) - (v[i + 1].y - v[i].y) * (v[i + 2].x - v[i].x);
+			if (area <= 0.0f) continue;
+			frame.triangles.push_back({{v[i], v[i + 1], v[i + 2]}, color});
+		}
+	}
+}
+
+// CLEARS SCREEN AND ZBUFFER AND DRAWS EVERY CUBE (PLACED BY ITS model) IN ONE RASTER PASS, ALL SHARING cube_mesh()
+// A CUBE WHOSE BOUNDING SPHERE IS OUTSIDE THE VIEW IS SKIPPED, ONE WHOSE EDGE IS LESS THAN CUBE_N ROWS ACROSS
+// (STICKERS SMALLER THAN A CELL) ONLY GETS ITS SIX SIDES, WITH depth_rejection THE NEAREST CUBE IS QUEUED FIRST
+void render_cubes(const std::vector<const Cube*>& cubes, FrameContext& frame, const glm::mat4& proj, const glm::mat4& view) {
+	Framebuffer& screen = frame.canvas();
+	frame.zbuffer.resize(screen.width, screen.height);
+	frame.zbuffer.clear();
+	screen.clear();
+	frame.counts = RasterCounts{};
+
+	// THE STATIC LAYER OF render_cube DOES NOT DESCRIBE THIS SCREEN
+	frame.static_layer.valid = false;
+	frame.last_view = glm::mat4(0.0f);
+
+	const CubeMesh& mesh = cube_mesh();
+	glm::mat4 viewport_proj_view = cell_viewport(screen) * proj * view;
+	frame.triangles.clear();
+	{
+		ScopedTimer timer(STAGE_PROJECT);
+		frame.cube_order.clear();
+		for (uint32_t i = 0; i < cubes.size(); i++) {
+			const Cube* cube = cubes[i];
+			// BOUNDING SPHERE IN VIEW SPACE (MODELS ONLY ROTATE, TRANSLATE AND SCALE UNIFORMLY)
+			float radius = mesh.extent * std::sqrt(3.0f) * glm::length(glm::vec3(cube->model[0]));
+			glm::vec4 center = view * cube->model[3];
+			float near_depth = -center.z - radius;
+
+			// THE SPHERE'S PROJECTION IS BOUNDED BY ITS RADIUS AT THE NEAR SIDE, A CUBE REACHING BEHIND THE NEAR
+			// SIDE OF THE CAMERA IS ALWAYS DRAWN IN FULL
+			bool lod = false;
+			if (near_depth > 0.0f) {
+				float x = proj[0][0] * center.x / -center.z;
+				float y = proj[1][1] * center.y / -center.z;
+				float rx = proj[0][0] * radius / near_depth;
+				float ry = proj[1][1] * radius / near_depth;
+				if (x - rx > 1.0f || x + rx < -1.0f || y - ry > 1.0f || y + ry < -1.0f) {
+					if (render_stats.enabled) render_stats.culled_cubes++;
+					continue;
+				}
+				// THE SPHERE IS sqrt(3) TIMES AS WIDE AS AN EDGE OF THE CUBE, WHICH SPANS CUBE_N STICKERS
+				lod = ry * screen.height < std::sqrt(3.0f) * CUBE_N;
+			}
+
+			// THE LOW BIT OF THE INDEX MARKS A CUBE DRAWN AT THE LOWER LEVEL OF DETAIL
+			frame.cube_order.push_back({near_depth, i * 2 + lod});
+		}
+
+		if (depth_rejection()) std::sort(frame.cube_order.begin(), frame.cube_order.end());
+		for (const DrawOrder& order : frame.cube_order) {
+			const Cube& cube = *cubes[order.index / 2];
+			if (order.index % 2) {
+				if (render_stats.enabled) render_stats.lod_cubes++;
+				project_sides(cube, frame, viewport_proj_view);
+			} else {
+				project_mesh(cube, frame, proj, view);
+			}
+		}
+	}
+	rasterize_triangles(frame);
+	resolve_canvas(frame);
+}
+
+// SHELL SLOTS IN x, y, z ORDER, READ ONLY DATA BUILT BY THE COMPILER (SHELL_UNITS SLOTS EXACTLY, ONE MORE WOULD INDEX
+// PAST THE END AND ONE LESS FAILS THE CHECK BELOW)
+static constexpr std::array<Vec3i, SHELL_UNITS> unit_slots = [] {
+	std::array<Vec3i, SHELL_UNITS> s{};
+	const int last = CUBE_N - 1;
+	int n = 0;
+	for (int z = 0; z < CUBE_N; z++) {
+		for (int y = 0; y < CUBE_N; y++) {
+			for (int x = 0; x < CUBE_N; x++) {
+				bool shell = x == 0 || x == last || y == 0 || y == last || z == 0 || z == last;
+				if (shell) s[n++] = {x, y, z};
+			}
+		}
+	}
+	return s;
+}();
+static_assert(unit_slots[SHELL_UNITS - 1].x == CUBE_N - 1 && unit_slots[SHELL_UNITS - 1].y == CUBE_N - 1
+	&& unit_slots[SHELL_UNITS - 1].z == CUBE_N - 1, "every shell slot must be listed");
+
+// GRID SLOT (0 .. CUBE_N - 1 ON EACH AXIS) OF CUBE UNIT i, UNITS ARE THE SHELL SLOTS IN x, y, z ORDER
+Vec3i unit_grid(int i) {
+	return unit_slots[i];
+}
+
+// BUILDS CUBE (CUBE_N x CUBE_N x CUBE_N, OUTER SHELL ONLY) IN THE SOLVED STATE
+Cube MakeCube() {
+	Cube cube;
+	sync_cube(cube, solved_stickers());
+	cube.revision = 0;
+	return cube;
+}
+
+// SNAPS EVERY CUBE UNIT BACK TO ITS GRID SLOT AND REPAINTS STICKERS FROM THE LOGICAL STATE
+void sync_cube(Cube& cube, const Stickers& state) {
+	const CubeMesh& mesh = cube_mesh();
+	cube.moving = {};
+	cube.revision++;
+	for (int i = 0; i < SHELL_UNITS; i++) {
+		CubeUnit& cube_unit = cube.units[i];
+		cube_unit.grid = unit_grid(i);
+		cube_unit.orientation = 0;
+		cube_unit.angle = 0.0f;
+		cube_unit.position = unit_position(cube_unit.grid);
+		cube_unit.rotation = glm::mat4(1.0f);
+		for (int p = 0; p < 6; p++) {
+			int s = mesh.face_sticker[i * 6 + p];
+			cube.face_color[i * 6 + p] = s < 0 ? (uint8_t)COLOR_BLACK : face_colors[state[s]];
+		}
+	}
+}
+
+// ORBIT CAMERA LOOKING AT THE ORIGIN FROM pitch/yaw, distance 0 PICKS ONE THAT FRAMES A SINGLE CUBE
+glm::mat4 camera_view(float pitch, float yaw, float distance) {
+	glm::vec3 camera;
+
+	// R = CAMERA RADIUS TO CUBE, GROWS WITH THE CUBE SO IT ALWAYS FILLS THE SAME PART OF THE VIEW
+	float r = distance > 0.0f ? distance : 8.0f * CUBE_N / 3.0f;
+	camera.x = r * std::cos(pitch) * std::sin(yaw);
+	camera.y = r * std::sin(pitch);
+	camera.z = r * std::cos(pitch) * std::cos(yaw);
+
+	return glm::lookAt(camera, glm::vec3(0.0f), glm::vec3(0, 1, 0));
+}
+
+// PERSPECTIVE PROJECTION CORRECTED FOR TERMINAL CELLS BEING TWICE AS TALL AS WIDE
+glm::mat4 camera_projection(int width, int height) {
+	float fov = glm::radians(70.0f);
+	float aspectRatio = (float)width / (float)height / 2.0;
+	return glm::perspective(fov, aspectRatio, 0.1f, 100.0f);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "Framebuffer.hpp"
+#include <glm/glm.hpp>
+#include "CubeUnit.hpp"
+#include "Stickers.hpp"
+#include "Raster.hpp"
+#include "Tiles.hpp"
+#include "SubCell.hpp"
+
+// COLOR AND DEPTH OF THE CUBE UNITS THAT ARE NOT TURNING, RASTERIZED ONCE AND REUSED AS THE BACKGROUND OF EVERY
+// FRAME WHILE THE CAMERA, SCREEN SIZE AND SET OF TURNING UNITS STAY THE SAME (ONLY THE TURNING SLICE IS REDRAWN)
+struct StaticLayer {
+	bool valid = false;
+	glm::mat4 view;
+	glm::mat4 proj;
+	int width = 0;
+	int height = 0;
+	uint32_t revision = 0;
+	std::array<uint8_t, SHELL_UNITS> moving = {};
+
+	// DEPTH (INFINITY WHERE NO STATIC TRIANGLE COVERS IT) AND CELLS, BOTH COPIED BACK AS A WHOLE
+	std::vector<float> depth;
+	std::vector<Cell> cells;
+
+	bool matches(const Cube& cube, const glm::mat4& view, const glm::mat4& proj, int width, int height) const;
+};
+
+// SORT KEY OF A FACE OR CUBE DRAWN FRONT TO BACK, depth GROWS WITH THE DISTANCE FROM THE CAMERA
+struct DrawOrder {
+	float depth;
+	uint32_t index;
+
+	bool operator<(const DrawOrder& other) const { return depth < other.depth; }
+};
+
+// SCREEN, ZBUFFER, VISIBLE FACES, PROJECTED VERTICES AND TRIANGLE LIST KEPT ACROSS FRAMES, RETURNS TRUE IF resize HAD TO REALLOCATE
+// screen ALWAYS HAS THE TERMINAL SIZE, IN A SUB-CELL cell_mode THE CUBE IS RASTERIZED INTO subcells AND RESOLVED INTO IT
+// (SET cell_mode BEFORE resize, THE ZBUFFER AND STATIC LAYER ALWAYS HAVE THE SIZE OF canvas)
+struct FrameContext {
+	Framebuffer screen;
+	CellMode cell_mode = CellMode::Full;
+	Framebuffer subcells;
+	ZBuffer zbuffer;
+	std::vector<uint16_t> visible_faces;
+	std::vector<DrawOrder> face_order;
+	std::vector<DrawOrder> cube_order;
+	std::vector<float> screen_x, screen_y, screen_z;
+	std::vector<ScreenTriangle> triangles;
+	TileRasterizer tiles;
+
+	// THE CAMERA OF THE LAST FRAME, THE STATIC LAYER IS ONLY BUILT ONCE THE CAMERA HELD STILL FOR A FRAME
+	glm::mat4 last_view = glm::mat4(0.0f);
+	glm::mat4 last_proj = glm::mat4(0.0f);
+	StaticLayer static_layer;
+
+	// RASTER WORK OF THE LAST FRAME (ONLY THE TURNING UNITS WHILE THE STATIC LAYER IS REUSED)
+	RasterCounts counts;
+
+	bool resize(int width, int height);
+
+	// WHAT THE TRIANGLES ARE RASTERIZED INTO
+	Framebuffer& canvas() { return cell_mode == CellMode::Full ? screen : subcells; }
+};
+
+// OPTIONAL TIMING COLLECTED BY THE RASTERIZER (ONLY WHEN enabled, USED BY --bench)
+struct RenderStats {
+	bool enabled = false;
+	double raster_seconds = 0.0;
+	long triangles = 0;
+
+	// SECONDS SPENT RESOLVING SUB-CELL SAMPLES INTO CELLS
+	double resolve_seconds = 0.0;
+
+	// CUBES render_cubes LEFT OUT OR DREW AT THE LOWER LEVEL OF DETAIL
+	long culled_cubes = 0;
+	long lod_cubes = 0;
+};
+extern RenderStats render_stats;
+
+// CONSTRUCTS PLANE FROM NORMAL
+Plane MakePlane(glm::vec3 normal, uint8_t color, bool invert_normal);
+
+// CONSTRUCTS THE PLANES OF THE CUBE UNIT IN GRID SLOT grid, FACES ON THE OUTSIDE OF THE CUBE GET THEIR SOLVED COLOR
+std::array<Plane, 6> MakeUnitPlanes(Vec3i grid);
+
+// THE MESH EVERY CUBE IS DRAWN WITH, COMPILED FROM THE PLANES OF EVERY CUBE UNIT ON FIRST USE
+const CubeMesh& cube_mesh();
+
+// WHICH CUBE UNITS project_mesh QUEUES, BY cube.moving
+enum class UnitSet { All, Static, Moving };
+
+// PICKS THE FACES THAT CAN BE SEEN THIS FRAME, THEN TRANSFORMS ONLY THEIR VERTICES STRAIGHT TO CELL COORDINATES
+// (ONE MATRIX PER CUBE UNIT) AND QUEUES THE FRONT FACING TRIANGLES, NEAREST FACE FIRST WITH depth_rejection
+void project_mesh(const Cube& cube, FrameContext& frame, const glm::mat4& proj, const glm::mat4& view, UnitSet units = UnitSet::All);
+
+// CLEARS SCREEN AND ZBUFFER, PROJECTS EVERY CUBE UNIT THEN RASTERIZES THE FRAME ON frame.tiles
+// DURING A TURN WITH A STILL CAMERA THE UNITS THAT DO NOT MOVE COME FROM frame.static_layer INSTEAD
+// A SUB-CELL frame.cell_mode IS RESOLVED INTO frame.screen AT THE END
+void render_cube(const Cube& cube, FrameContext& frame, const glm::mat4& proj, const glm::mat4& view);
+
+// CLEARS SCREEN AND ZBUFFER AND DRAWS EVERY CUBE (PLACED BY ITS model) IN ONE RASTER PASS, ALL SHARING cube_mesh()
+// CUBES OUTSIDE THE VIEW ARE SKIPPED, CUBES TOO SMALL TO SHOW THEIR STICKERS ONLY GET ONE QUAD PER SIDE
+// WITH depth_rejection THE NEAREST CUBE COMES FIRST, SO THE COARSE DEPTH TEST CAN DROP WHAT IT HIDES
+void render_cubes(const std::vector<const Cube*>& cubes, FrameContext& frame, const glm::mat4& proj, const glm::mat4& view);
+
+// GRID SLOT (0 .. CUBE_N - 1 ON EACH AXIS) OF CUBE UNIT i, UNITS ARE THE SHELL SLOTS IN x, y, z ORDER
+Vec3i unit_grid(int i);
+
+// CUBE SPACE POSITION OF THE CENTER OF GRID SLOT g
+glm::vec3 unit_position(Vec3i g);
+
+// BUILDS CUBE (CUBE_N x CUBE_N x CUBE_N, OUTER SHELL ONLY)
+Cube MakeCube();
+
+// SNAPS EVERY CUBE UNIT BACK TO ITS GRID SLOT AND REPAINTS STICKERS FROM THE LOGICAL STATE
+void sync_cube(Cube& cube, const Stickers& state);
+
+// ORBIT CAMERA LOOKING AT THE ORIGIN FROM pitch/yaw, distance 0 PICKS ONE THAT FRAMES A SINGLE CUBE
+glm::mat4 camera_view(float pitch, float yaw, float distance = 0.0f);
+
+// PERSPECTIVE PROJECTION CORRECTED FOR TERMINAL CELLS BEING TWICE AS TALL AS WIDE
+glm::mat4 camera_projection(int width, int height);
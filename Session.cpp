@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include "Session.hpp"
+
+void Session::queue_move(const Move& move) {
+	std::erase_if(move_queue, [](const QueuedMove& queued) { return queued.solution; });
+	move_queue.push_back({move, false});
+	start_queued();
+}
+
+void Session::queue_solution(const std::vector<Move>& moves) {
+	std::erase_if(move_queue, [](const QueuedMove& queued) { return queued.solution; });
+	for (const Move& move : moves) move_queue.push_back({move, true});
+	start_queued();
+}
+
+void Session::camera_impulse(int yaw_steps, int pitch_steps) {
+	// ONE ADDITION PER KEY PRESS, SO A RECORDED PRESS LANDS ON EXACTLY THE SAME FLOAT
+	for (int i = 0; i < std::abs(yaw_steps); i++) yaw_vel += yaw_steps > 0 ? CAMERA_IMPULSE : -CAMERA_IMPULSE;
+	for (int i = 0; i < std::abs(pitch_steps); i++) pitch_vel += pitch_steps > 0 ? CAMERA_IMPULSE : -CAMERA_IMPULSE;
+}
+
+bool Session::undo_move(Move& move) const {
+	MoveHistory planned = move_list;
+	for (const QueuedMove& queued : move_queue) {
+		if (!queued.solution) planned.push(queued.move);
+	}
+	if (!last_move(planned.letters, move)) return false;
+	move = inverse_move(move);
+	return true;
+}
+
+Stickers Session::planned_state() const {
+	Stickers planned = cube_state;
+	for (const QueuedMove& queued : move_queue) {
+		if (!queued.solution) apply_move(planned, queued.move);
+	}
+	return planned;
+}
+
+void Session::start_queued() {
+	while (!move_queue.empty() && animations.can_start(move_queue.front().move)) {
+		Move move = move_queue.front().move;
+		move_queue.pop_front();
+		animations.start(cube, cube_state, move);
+		move_list.push(move);
+	}
+}
+
+void Session::step() {
+	ticks++;
+
+	// CLAMP PRECISION TO AVOID ARTIFACTS
+	if (std::abs(yaw_vel) < 0.001) yaw_vel = 0.0f;
+	if (std::abs(pitch_vel) < 0.001) pitch_vel = 0.0f;
+
+	// ADVANCE RUNNING TURNS, FASTER THE MORE ARE WAITING SO PLAYBACK KEEPS UP WITH FAST INPUT
+	double speed = std::min(MAX_TURN_SPEED, 1.0 + 2.0 * move_queue.size());
+	animations.advance(cube, cube_state, speed);
+	start_queued();
+
+	// APPLY VELOCITIES FOR SMOOTH ROTATION
+	yaw += yaw_vel;
+	yaw_vel /= 1.1;
+	pitch += pitch_vel;
+	pitch_vel /= 1.1;
+
+	// SMOOTHLY CLAMP VIEW TO PSEUDO-ISOMETRIC RANGE
+	if (pitch > PITCH_ISO) {
+		pitch = 0.99*pitch + 0.01*PITCH_ISO;
+	} else if (pitch < -PITCH_ISO) {
+		pitch = 0.99*pitch - 0.01*PITCH_ISO;
+	}
+	if (yaw > YAW_ISO) {
+		yaw = 0.99*yaw + 0.01*YAW_ISO;
+	} else if (yaw < -YAW_ISO) {
+		yaw = 0.99*yaw - 0.01*YAW_ISO;
+	}
+
+	// SNAP ONTO THE RANGE ONCE CLOSE SO THE VIEW ACTUALLY COMES TO REST
+	if (std::abs(std::abs(pitch) - PITCH_ISO) < 0.0001f) pitch = std::copysign(PITCH_ISO, pitch);
+	if (std::abs(std::abs(yaw) - YAW_ISO) < 0.0001f) yaw = std::copysign(YAW_ISO, yaw);
+
+	if (yaw > glm::half_pi<float>() * 3) {
+		yaw -= glm::two_pi<float>();
+	}
+	if (yaw < -glm::half_pi<float>() * 3) {
+		yaw += glm::two_pi<float>();
+	}
+
+	// PITCH CANNOT GO ABOVE OR BELOW 2PI
+	pitch = glm::clamp(pitch, -glm::half_pi<float>() + 0.01f, glm::half_pi<float>() - 0.01f);
+}
+
+bool Session::settling() const {
+	return std::abs(pitch) > PITCH_ISO || std::abs(yaw) > YAW_ISO;
+}
+
+bool Session::idle() const {
+	return animations.empty() && move_queue.empty() && yaw_vel == 0.0f && pitch_vel == 0.0f && !settling();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "CubeUnit.hpp"
+#include "MoveHistory.hpp"
+#include "Render.hpp"
+#include "Stickers.hpp"
+#include "Transform.hpp"
+
+// A TURN WAITING IN THE MOVE QUEUE, SOLUTION MOVES ARE DROPPED WHEN ANOTHER MOVE IS TYPED
+struct QueuedMove {
+	Move move;
+	bool solution;
+};
+
+// FASTEST TURN PLAYBACK (IN NORMAL SIMULATION STEPS PER STEP) WHEN MANY MOVES ARE QUEUED
+constexpr double MAX_TURN_SPEED = 16.0;
+
+// CAMERA VELOCITY ONE KEY PRESS ADDS
+constexpr double CAMERA_IMPULSE = 0.05;
+
+// THE VIEW IS PULLED BACK INTO THIS PSEUDO-ISOMETRIC RANGE
+constexpr float PITCH_ISO = 0.6f;
+constexpr float YAW_ISO = 0.6f;
+
+// EVERYTHING THE SIMULATION OWNS, ONLY CHANGED THROUGH THE FUNCTIONS BELOW AND ADVANCED IN FIXED STEPS,
+// SO THE SAME INPUTS AT THE SAME ticks ALWAYS GIVE THE SAME SESSION (WHICH IS WHAT MAKES REPLAYS EXACT)
+struct Session {
+	// cube_state IS THE SOURCE OF TRUTH, cube ONLY HOLDS GEOMETRY FOR RENDERING
+	Cube cube = MakeCube();
+	Stickers cube_state = solved_stickers();
+	TurnAnimations animations;
+	MoveHistory move_list;
+
+	// TURNS WAITING TO BE ANIMATED, TYPED ONES AND SOLUTION MOVES ALIKE
+	std::deque<QueuedMove> move_queue;
+
+	float pitch = 0.0f;
+	float yaw = 0.0f;
+	float pitch_vel = 0.0f;
+	float yaw_vel = 0.0f;
+
+	// SIMULATION STEPS TAKEN SO FAR
+	uint64_t ticks = 0;
+
+	// QUEUES A TYPED MOVE, A QUEUED SOLUTION IS ABANDONED
+	void queue_move(const Move& move);
+
+	// REPLACES ANY QUEUED SOLUTION WITH moves
+	void queue_solution(const std::vector<Move>& moves);
+
+	// ADDS steps KEY PRESSES WORTH OF CAMERA VELOCITY (NEGATIVE FOR THE OTHER DIRECTION)
+	void camera_impulse(int yaw_steps, int pitch_steps);
+
+	// INVERSE OF THE LAST MOVE OF THE HISTORY FOLLOWED BY THE QUEUED TYPED MOVES, FALSE IF THERE IS NONE
+	bool undo_move(Move& move) const;
+
+	// STATE THE QUEUED TYPED MOVES LEAD TO
+	Stickers planned_state() const;
+
+	// STARTS QUEUED TURNS IN ORDER WHILE THEY COMMUTE WITH THE RUNNING ONES, THE HISTORY GETS THEM AS THEY START
+	void start_queued();
+
+	// ONE SIMULATION STEP (SIM_STEP SECONDS) OF TURNS AND CAMERA
+	void step();
+
+	// TRUE WHILE THE CAMERA IS OUTSIDE THE PSEUDO-ISOMETRIC RANGE AND BEING PULLED BACK
+	bool settling() const;
+
+	// NO TURN (OR QUEUED MOVE), CAMERA VELOCITY OR CLAMP IS STILL MOVING THE SCENE
+	bool idle() const;
+};
@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "Snapshot.hpp"
+#include "Output.hpp"
+#include "Render.hpp"
+
+int run_snapshot(int argc, char** argv) {
+	std::string path;
+	std::string moves;
+	int width = 80;
+	int height = 24;
+	float pitch = 0.6f;
+	float yaw = 0.6f;
+	OutputMode mode = OutputMode::Ppm;
+	CellMode cell_mode = CellMode::Full;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+			path = argv[++i];
+		} else if (std::strcmp(argv[i], "--moves") == 0 && i + 1 < argc) {
+			moves = argv[++i];
+		} else if (std::strcmp(argv[i], "--pitch") == 0 && i + 1 < argc) {
+			pitch = std::atof(argv[++i]);
+		} else if (std::strcmp(argv[i], "--yaw") == 0 && i + 1 < argc) {
+			yaw = std::atof(argv[++i]);
+		} else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+				std::cerr << "invalid --size " << argv[i] << " (expected WxH)\n";
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			if (!parse_output_mode(name, mode)) {
+				std::cerr << "unknown --output " << name << " (expected ppm, ftxui, ansi16, ansi256 or truecolor)\n";
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--subcell") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			if (!parse_cell_mode(name, cell_mode)) {
+				std::cerr << "unknown --subcell " << name << " (expected full, half or quad)\n";
+				return 1;
+			}
+		}
+	}
+	if (path.empty()) {
+		std::cerr << "--snapshot needs an output file\n";
+		return 1;
+	}
+
+	// MOVES GO STRAIGHT TO THE LOGICAL STATE, THE CUBE IS THEN PAINTED FROM IT (NO ANIMATION)
+	Stickers state = solved_stickers();
+	for (size_t at = 0; at < moves.size();) {
+		if (moves[at] == ' ') {
+			at++;
+			continue;
+		}
+		Move move;
+		if (!read_move(moves, at, move)) {
+			std::cerr << "not a move at position " << at << " of --moves\n";
+			return 1;
+		}
+		apply_move(state, move);
+	}
+	Cube cube = MakeCube();
+	sync_cube(cube, state);
+
+	FrameContext frame;
+	frame.cell_mode = cell_mode;
+	frame.resize(width, height);
+	render_cube(cube, frame, camera_projection(width, height), camera_view(pitch, yaw));
+
+	std::unique_ptr<FrameEncoder> encoder = make_encoder(mode);
+	const std::string& bytes = encoder->encode(frame.screen);
+	std::ofstream out(path, std::ios::binary);
+	out.write(bytes.data(), bytes.size());
+	if (!out) {
+		std::cerr << "could not write snapshot to " << path << "\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// HEADLESS SNAPSHOT: RENDERS ONE FRAME OF THE CUBE AFTER A MOVE SEQUENCE AND WRITES IT TO A FILE, FOR GOLDEN IMAGES
+// PPM (THE DEFAULT) IS AN IMAGE, THE TERMINAL OUTPUTS WRITE THE BYTES A FULL REDRAW WOULD SEND
+// USAGE: RubiksRays --snapshot FILE [--size WxH] [--moves SEQUENCE] [--pitch RADIANS] [--yaw RADIANS]
+//        [--output ppm|ftxui|ansi16|ansi256|truecolor] [--subcell full|half|quad]
+int run_snapshot(int argc, char** argv);
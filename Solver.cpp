@@ -0,0 +1,571 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Solver.hpp"
+
+// COORDINATE SIZES
+static const int TWIST_COUNT = 2187;     // 3^7 CORNER ORIENTATIONS
+static const int FLIP_COUNT = 2048;      // 2^11 EDGE ORIENTATIONS
+static const int SLICE_COUNT = 11880;    // 495 POSITIONS OF THE 4 SLICE EDGES * 24 ORDERS
+static const int COMB_COUNT = 495;
+static const int PERM_COUNT = 40320;     // 8! CORNER OR U/D EDGE PERMUTATIONS
+static const int SLICE_PERM_COUNT = 24;
+
+static const int MAX_LENGTH = 32;
+static const int MAX_PHASE1 = 20;
+static const int MAX_PHASE2 = 18;
+
+// PHASE 2 IS FIRST CAPPED SHORTER: A LONG PHASE 2 COSTS FAR MORE THAN TRYING THE NEXT PHASE 1 SOLUTION
+static const int QUICK_PHASE2 = 12;
+
+// MOVES THAT KEEP A CUBE INSIDE THE PHASE 2 SUBGROUP
+static const int phase2_moves[10] = {0, 1, 2, 9, 10, 11, 4, 13, 7, 16}; // U U2 U' D D2 D' R2 L2 F2 B2
+
+static bool is_phase2_move(int move) {
+	int face = move / 3;
+	return face == FACE_U || face == FACE_D || move % 3 == 1;
+}
+
+// CANONICAL ORDER: NEVER TURN THE SAME FACE TWICE IN A ROW, OPPOSITE FACES ONLY IN ASCENDING ORDER
+static bool skip_after(int move, int last) {
+	int face = move / 3;
+	int last_face = last / 3;
+	return face == last_face || (face == (last_face + 3) % 6 && face < last_face);
+}
+
+// ---- COORDINATES ----
+
+static constexpr int binomial(int n, int k) {
+	if (k < 0 || k > n) return 0;
+	int r = 1;
+	for (int i = 0; i < k; i++) r = r * (n - i) / (i + 1);
+	return r;
+}
+
+// LEHMER RANK OF A PERMUTATION OF n VALUES (ANY n DISTINCT VALUES, ONLY THEIR ORDER MATTERS)
+static constexpr int permutation_rank(const uint8_t* values, int n) {
+	int rank = 0;
+	for (int i = 0; i < n; i++) {
+		int smaller = 0;
+		for (int j = i + 1; j < n; j++) smaller += values[j] < values[i];
+		rank = rank * (n - i) + smaller;
+	}
+	return rank;
+}
+
+// INVERSE OF permutation_rank OVER THE VALUES base .. base + n - 1
+static void permutation_unrank(int rank, uint8_t* values, int n, int base) {
+	int digits[12];
+	for (int i = n - 1; i >= 0; i--) {
+		digits[i] = rank % (n - i);
+		rank /= n - i;
+	}
+	bool used[12] = {};
+	for (int i = 0; i < n; i++) {
+		int skip = digits[i];
+		for (int v = 0; v < n; v++) {
+			if (used[v]) continue;
+			if (skip-- == 0) {
+				used[v] = true;
+				values[i] = (uint8_t)(base + v);
+				break;
+			}
+		}
+	}
+}
+
+static int get_twist(const CubeState& s) {
+	int twist = 0;
+	for (int i = 0; i < 7; i++) twist = twist * 3 + s.co[i];
+	return twist;
+}
+
+static void set_twist(CubeState& s, int twist) {
+	int sum = 0;
+	for (int i = 6; i >= 0; i--) {
+		s.co[i] = twist % 3;
+		sum += s.co[i];
+		twist /= 3;
+	}
+	s.co[7] = (3 - sum % 3) % 3;
+}
+
+static int get_flip(const CubeState& s) {
+	int flip = 0;
+	for (int i = 0; i < 11; i++) flip = flip * 2 + s.eo[i];
+	return flip;
+}
+
+static void set_flip(CubeState& s, int flip) {
+	int sum = 0;
+	for (int i = 10; i >= 0; i--) {
+		s.eo[i] = flip % 2;
+		sum += s.eo[i];
+		flip /= 2;
+	}
+	s.eo[11] = sum % 2;
+}
+
+// POSITIONS OF THE SLICE EDGES (FR FL BL BR) AS A COMBINATION (0 = ALL IN THE SLICE) TIMES 24 PLUS THEIR ORDER
+static constexpr int get_slice(const CubeState& s) {
+	int comb = 0;
+	int found = 0;
+	uint8_t order[4];
+	for (int j = 11; j >= 0; j--) {
+		if (s.ep[j] >= 8) {
+			comb += binomial(11 - j, found + 1);
+			order[3 - found] = s.ep[j];
+			found++;
+		}
+	}
+	return comb * SLICE_PERM_COUNT + permutation_rank(order, 4);
+}
+
+// POSITIONS OF EVERY COMBINATION, FOUND BY THE COMPILER ENUMERATING THE 4-SUBSETS OF 12 SLOTS
+static constexpr std::array<std::array<uint8_t, 4>, COMB_COUNT> slice_positions = [] {
+	std::array<std::array<uint8_t, 4>, COMB_COUNT> p{};
+	for (int mask = 0; mask < 1 << 12; mask++) {
+		if (__builtin_popcount(mask) != 4) continue;
+		CubeState probe;
+		std::array<uint8_t, 4> slots{};
+		int n = 0;
+		for (int j = 0; j < 12; j++) {
+			probe.ep[j] = mask >> j & 1 ? 8 : 0;
+			if (mask >> j & 1) slots[n++] = (uint8_t)j;
+		}
+		p[get_slice(probe) / SLICE_PERM_COUNT] = slots;
+	}
+	return p;
+}();
+
+static void set_slice(CubeState& s, int slice) {
+	uint8_t order[4];
+	permutation_unrank(slice % SLICE_PERM_COUNT, order, 4, 8);
+	const std::array<uint8_t, 4>& slots = slice_positions[slice / SLICE_PERM_COUNT];
+	uint8_t other = 0;
+	for (int j = 0, n = 0; j < 12; j++) {
+		if (n < 4 && slots[n] == j) {
+			s.ep[j] = order[n++];
+		} else {
+			s.ep[j] = other++;
+		}
+	}
+}
+
+static int get_corners(const CubeState& s) {
+	return permutation_rank(s.cp.data(), 8);
+}
+
+static void set_corners(CubeState& s, int perm) {
+	permutation_unrank(perm, s.cp.data(), 8, 0);
+}
+
+// ONLY MEANINGFUL IN PHASE 2, WHERE EDGES 0..7 STAY IN THE U AND D LAYERS
+static int get_ud_edges(const CubeState& s) {
+	return permutation_rank(s.ep.data(), 8);
+}
+
+static void set_ud_edges(CubeState& s, int perm) {
+	permutation_unrank(perm, s.ep.data(), 8, 0);
+	for (int j = 8; j < 12; j++) s.ep[j] = (uint8_t)j;
+}
+
+// THE STATE THAT UNDOES s: multiply(s, invert(s)) IS THE SOLVED CUBE
+static CubeState invert(const CubeState& s) {
+	CubeState r;
+	for (int i = 0; i < 8; i++) {
+		r.cp[s.cp[i]] = (uint8_t)i;
+		r.co[s.cp[i]] = (uint8_t)((3 - s.co[i]) % 3);
+	}
+	for (int i = 0; i < 12; i++) {
+		r.ep[s.ep[i]] = (uint8_t)i;
+		r.eo[s.ep[i]] = s.eo[i];
+	}
+	for (int i = 0; i < 6; i++) r.centers[s.centers[i]] = (uint8_t)i;
+	return r;
+}
+
+static int orientation_inverse(int o) {
+	int p = 0;
+	while (orientation_product(o, p) != 0) p++;
+	return p;
+}
+
+// ---- TABLES ----
+
+// EVERY TABLE LIVES IN ONE BLOB THAT IS EXACTLY THE CACHE FILE: HEADER, MOVE TABLES (uint16 [coordinate][move]),
+// THEN PRUNING TABLES (uint8 MOVES TO THE PHASE GOAL, INDEXED a * size_b + b)
+struct TableHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t size;
+};
+
+static const char TABLE_MAGIC[8] = {'R', 'R', 'S', 'O', 'L', 'V', 'E', 'R'};
+static const uint32_t TABLE_VERSION = 2;
+
+struct TableLayout {
+	size_t twist_move, flip_move, slice_move, corner_move, ud_edge_move;
+	size_t twist_prune, flip_prune, twist_flip_prune, corner_prune, ud_edge_prune;
+	size_t size;
+};
+
+static TableLayout table_layout() {
+	TableLayout l;
+	size_t at = sizeof(TableHeader);
+	auto take = [&](size_t bytes) {
+		size_t offset = (at + 15) & ~(size_t)15;
+		at = offset + bytes;
+		return offset;
+	};
+	l.twist_move = take(sizeof(uint16_t) * TWIST_COUNT * FACE_MOVE_COUNT);
+	l.flip_move = take(sizeof(uint16_t) * FLIP_COUNT * FACE_MOVE_COUNT);
+	l.slice_move = take(sizeof(uint16_t) * SLICE_COUNT * FACE_MOVE_COUNT);
+	l.corner_move = take(sizeof(uint16_t) * PERM_COUNT * FACE_MOVE_COUNT);
+	l.ud_edge_move = take(sizeof(uint16_t) * PERM_COUNT * FACE_MOVE_COUNT);
+	l.twist_prune = take(COMB_COUNT * TWIST_COUNT);
+	l.flip_prune = take(COMB_COUNT * FLIP_COUNT);
+	l.twist_flip_prune = take(TWIST_COUNT * FLIP_COUNT);
+	l.corner_prune = take(PERM_COUNT * SLICE_PERM_COUNT);
+	l.ud_edge_prune = take(PERM_COUNT * SLICE_PERM_COUNT);
+	l.size = at;
+	return l;
+}
+
+struct SolverTables {
+	const uint16_t* twist_move;
+	const uint16_t* flip_move;
+	const uint16_t* slice_move;
+	const uint16_t* corner_move;
+	const uint16_t* ud_edge_move;    // PHASE 2 MOVES ONLY
+	const uint8_t* twist_prune;      // [slice combination][twist]
+	const uint8_t* flip_prune;       // [slice combination][flip]
+	const uint8_t* twist_flip_prune; // [twist][flip]
+	const uint8_t* corner_prune;     // [corner permutation][slice order]
+	const uint8_t* ud_edge_prune;    // [u/d edge permutation][slice order]
+};
+
+static SolverTables tables;
+static bool tables_loaded = false;
+static std::vector<uint8_t> generated_blob;
+
+static void fill_move_table(uint16_t* table, int count, int (*get)(const CubeState&), void (*set)(CubeState&, int), bool phase2_only) {
+	for (int c = 0; c < count; c++) {
+		CubeState s;
+		set(s, c);
+		for (int m = 0; m < FACE_MOVE_COUNT; m++) {
+			bool valid = !phase2_only || is_phase2_move(m);
+			table[c * FACE_MOVE_COUNT + m] = valid ? (uint16_t)get(multiply(s, move_table(m))) : 0;
+		}
+	}
+}
+
+// BREADTH FIRST DISTANCES OVER THE PRODUCT OF TWO COORDINATES (INDEX a * size_b + b) FROM THE GOAL (0, 0)
+// ONCE MOST ENTRIES ARE KNOWN IT SEARCHES BACKWARDS FROM THE UNKNOWN ONES, WHICH TOUCHES FAR FEWER ENTRIES
+static void fill_pruning(uint8_t* table, int size_a, const uint16_t* move_a, int size_b, const uint16_t* move_b,
+		const int* moves, int move_count) {
+	const uint8_t unknown = 0xff;
+	size_t total = (size_t)size_a * size_b;
+	std::memset(table, unknown, total);
+	table[0] = 0;
+	size_t done = 1;
+
+	for (uint8_t depth = 0; done < total; depth++) {
+		bool backwards = done > total / 2;
+		for (size_t i = 0; i < total; i++) {
+			if (backwards ? table[i] != unknown : table[i] != depth) continue;
+			int a = (int)(i / size_b);
+			int b = (int)(i % size_b);
+			for (int k = 0; k < move_count; k++) {
+				int m = moves[k];
+				size_t next = (size_t)move_a[a * FACE_MOVE_COUNT + m] * size_b + move_b[b * FACE_MOVE_COUNT + m];
+				if (backwards) {
+					if (table[next] == depth) {
+						table[i] = depth + 1;
+						done++;
+						break;
+					}
+				} else if (table[next] == unknown) {
+					table[next] = depth + 1;
+					done++;
+				}
+			}
+		}
+	}
+}
+
+static void generate_tables(uint8_t* blob, const TableLayout& l) {
+	TableHeader header;
+	std::memcpy(header.magic, TABLE_MAGIC, sizeof(header.magic));
+	header.version = TABLE_VERSION;
+	header.size = (uint32_t)l.size;
+	std::memcpy(blob, &header, sizeof(header));
+
+	uint16_t* twist_move = (uint16_t*)(blob + l.twist_move);
+	uint16_t* flip_move = (uint16_t*)(blob + l.flip_move);
+	uint16_t* slice_move = (uint16_t*)(blob + l.slice_move);
+	uint16_t* corner_move = (uint16_t*)(blob + l.corner_move);
+	uint16_t* ud_edge_move = (uint16_t*)(blob + l.ud_edge_move);
+	fill_move_table(twist_move, TWIST_COUNT, get_twist, set_twist, false);
+	fill_move_table(flip_move, FLIP_COUNT, get_flip, set_flip, false);
+	fill_move_table(slice_move, SLICE_COUNT, get_slice, set_slice, false);
+	fill_move_table(corner_move, PERM_COUNT, get_corners, set_corners, false);
+	fill_move_table(ud_edge_move, PERM_COUNT, get_ud_edges, set_ud_edges, true);
+
+	// SLICE COMBINATION (PHASE 1) AND SLICE ORDER (PHASE 2, COMBINATION 0) ON THEIR OWN
+	std::vector<uint16_t> comb_move(COMB_COUNT * FACE_MOVE_COUNT);
+	std::vector<uint16_t> order_move(SLICE_PERM_COUNT * FACE_MOVE_COUNT);
+	for (int m = 0; m < FACE_MOVE_COUNT; m++) {
+		for (int c = 0; c < COMB_COUNT; c++) {
+			comb_move[c * FACE_MOVE_COUNT + m] = slice_move[c * SLICE_PERM_COUNT * FACE_MOVE_COUNT + m] / SLICE_PERM_COUNT;
+		}
+		for (int p = 0; p < SLICE_PERM_COUNT; p++) {
+			order_move[p * FACE_MOVE_COUNT + m] = is_phase2_move(m) ? slice_move[p * FACE_MOVE_COUNT + m] : 0;
+		}
+	}
+
+	int all_moves[FACE_MOVE_COUNT];
+	for (int m = 0; m < FACE_MOVE_COUNT; m++) all_moves[m] = m;
+	fill_pruning(blob + l.twist_prune, COMB_COUNT, comb_move.data(), TWIST_COUNT, twist_move, all_moves, FACE_MOVE_COUNT);
+	fill_pruning(blob + l.flip_prune, COMB_COUNT, comb_move.data(), FLIP_COUNT, flip_move, all_moves, FACE_MOVE_COUNT);
+	fill_pruning(blob + l.twist_flip_prune, TWIST_COUNT, twist_move, FLIP_COUNT, flip_move, all_moves, FACE_MOVE_COUNT);
+	fill_pruning(blob + l.corner_prune, PERM_COUNT, corner_move, SLICE_PERM_COUNT, order_move.data(), phase2_moves, 10);
+	fill_pruning(blob + l.ud_edge_prune, PERM_COUNT, ud_edge_move, SLICE_PERM_COUNT, order_move.data(), phase2_moves, 10);
+}
+
+static void point_tables(const uint8_t* blob, const TableLayout& l) {
+	tables.twist_move = (const uint16_t*)(blob + l.twist_move);
+	tables.flip_move = (const uint16_t*)(blob + l.flip_move);
+	tables.slice_move = (const uint16_t*)(blob + l.slice_move);
+	tables.corner_move = (const uint16_t*)(blob + l.corner_move);
+	tables.ud_edge_move = (const uint16_t*)(blob + l.ud_edge_move);
+	tables.twist_prune = blob + l.twist_prune;
+	tables.flip_prune = blob + l.flip_prune;
+	tables.twist_flip_prune = blob + l.twist_flip_prune;
+	tables.corner_prune = blob + l.corner_prune;
+	tables.ud_edge_prune = blob + l.ud_edge_prune;
+	tables_loaded = true;
+}
+
+// MAPS AN EXISTING CACHE FILE, RETURNS FALSE IF IT IS MISSING OR DOES NOT MATCH THE CURRENT LAYOUT
+static bool map_tables(const std::string& path, const TableLayout& l) {
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size != l.size) {
+		close(fd);
+		return false;
+	}
+	void* mapped = mmap(nullptr, l.size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) return false;
+
+	TableHeader header;
+	std::memcpy(&header, mapped, sizeof(header));
+	if (std::memcmp(header.magic, TABLE_MAGIC, sizeof(header.magic)) != 0 || header.version != TABLE_VERSION || header.size != l.size) {
+		munmap(mapped, l.size);
+		return false;
+	}
+
+	// THE MAPPING STAYS FOR THE LIFETIME OF THE PROCESS
+	point_tables((const uint8_t*)mapped, l);
+	return true;
+}
+
+// WRITES TO A TEMPORARY FILE AND RENAMES IT, SO A CONCURRENT READER NEVER SEES A HALF WRITTEN CACHE
+static bool save_tables(const std::string& path, const std::vector<uint8_t>& blob) {
+	for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+		mkdir(path.substr(0, slash).c_str(), 0755);
+	}
+
+	std::string temp = path + ".tmp." + std::to_string(getpid());
+	FILE* file = std::fopen(temp.c_str(), "wb");
+	if (!file) return false;
+	bool ok = std::fwrite(blob.data(), 1, blob.size(), file) == blob.size();
+	ok = std::fclose(file) == 0 && ok;
+	if (ok) ok = std::rename(temp.c_str(), path.c_str()) == 0;
+	if (!ok) std::remove(temp.c_str());
+	return ok;
+}
+
+std::string default_solver_cache_path() {
+	const char* cache = std::getenv("XDG_CACHE_HOME");
+	if (cache && cache[0] == '/') return std::string(cache) + "/rubiksrays/solver.bin";
+	const char* home = std::getenv("HOME");
+	if (home && home[0] == '/') return std::string(home) + "/.cache/rubiksrays/solver.bin";
+	return "/tmp/rubiksrays-solver.bin";
+}
+
+bool load_solver_tables(const std::string& cache_path) {
+	if (tables_loaded) return true;
+
+	TableLayout l = table_layout();
+	if (map_tables(cache_path, l)) return true;
+
+	// GENERATE ONCE, A FAILED SAVE ONLY MEANS THE NEXT RUN GENERATES AGAIN
+	generated_blob.assign(l.size, 0);
+	generate_tables(generated_blob.data(), l);
+	save_tables(cache_path, generated_blob);
+	point_tables(generated_blob.data(), l);
+	return true;
+}
+
+// ---- SEARCH ----
+
+// THE CUBE IS SEARCHED TURNED SO EACH OF THE THREE AXES IS THE U/D AXIS, AND EACH OF THOSE ALSO INVERTED
+// THE SIX PHASE 1 SEARCHES FIND DIFFERENT SUBGROUP ENTRIES, SO A SHORT TOTAL TURNS UP FAR SOONER THAN IN ONE
+struct Direction {
+	int rotation;
+	bool inverse;
+	CubeState start;
+	int twist, flip, slice;
+	int lower;
+};
+
+struct Search {
+	const Direction* direction;
+	int path[MAX_LENGTH];
+	std::vector<int> best;
+	int best_length = MAX_LENGTH;
+	int target_length;
+	int phase2_limit;
+	std::chrono::steady_clock::time_point deadline;
+	long nodes = 0;
+	bool done = false;
+
+	bool phase2(int corners, int ud_edges, int order, int depth, int togo);
+	void start_phase2(int length);
+	void phase1(int twist, int flip, int slice, int depth, int togo);
+};
+
+bool Search::phase2(int corners, int ud_edges, int order, int depth, int togo) {
+	if (togo == 0) return corners == 0 && ud_edges == 0 && order == 0;
+
+	for (int m : phase2_moves) {
+		if (depth > 0 && skip_after(m, path[depth - 1])) continue;
+		int c = tables.corner_move[corners * FACE_MOVE_COUNT + m];
+		int e = tables.ud_edge_move[ud_edges * FACE_MOVE_COUNT + m];
+		int o = tables.slice_move[order * FACE_MOVE_COUNT + m];
+		int distance = std::max(tables.corner_prune[c * SLICE_PERM_COUNT + o], tables.ud_edge_prune[e * SLICE_PERM_COUNT + o]);
+		if (distance > togo - 1) continue;
+
+		path[depth] = m;
+		if (phase2(c, e, o, depth + 1, togo - 1)) return true;
+	}
+	return false;
+}
+
+// PHASE 1 REACHED THE SUBGROUP AFTER length MOVES, THE PHASE 2 COORDINATES COME FROM THE ACTUAL CUBIES
+void Search::start_phase2(int length) {
+	CubeState s = direction->start;
+	for (int i = 0; i < length; i++) apply_move(s, path[i]);
+	int corners = get_corners(s);
+	int ud_edges = get_ud_edges(s);
+	int order = get_slice(s);
+
+	int limit = std::min(best_length - 1 - length, phase2_limit);
+	int lower = std::max(tables.corner_prune[corners * SLICE_PERM_COUNT + order], tables.ud_edge_prune[ud_edges * SLICE_PERM_COUNT + order]);
+	for (int depth = lower; depth <= limit; depth++) {
+		if (!phase2(corners, ud_edges, order, length, depth)) continue;
+		// BACK TO MOVES OF THE UNTURNED CUBE, A SOLUTION OF THE INVERSE IS UNDONE BACKWARDS
+		best_length = length + depth;
+		best.clear();
+		for (int i = 0; i < best_length; i++) {
+			int m = direction->inverse ? inverse_move(path[best_length - 1 - i]) : path[i];
+			best.push_back(conjugate_move(direction->rotation, m));
+		}
+		if (best_length <= target_length) done = true;
+		return;
+	}
+}
+
+void Search::phase1(int twist, int flip, int slice, int depth, int togo) {
+	if (togo == 0) {
+		// A PHASE 1 SOLUTION ENDING IN A PHASE 2 MOVE IS A LONGER VERSION OF ONE ALREADY TRIED
+		if (depth == 0 || !is_phase2_move(path[depth - 1])) start_phase2(depth);
+		return;
+	}
+
+	if ((++nodes & 1023) == 0 && !best.empty() && std::chrono::steady_clock::now() > deadline) {
+		done = true;
+		return;
+	}
+
+	for (int m = 0; m < FACE_MOVE_COUNT; m++) {
+		if (depth > 0 && skip_after(m, path[depth - 1])) continue;
+		// EACH TABLE IS CHECKED AS SOON AS ITS COORDINATES ARE KNOWN, MOST MOVES FAIL THE FIRST ONE
+		int s = tables.slice_move[slice * FACE_MOVE_COUNT + m];
+		int comb = s / SLICE_PERM_COUNT;
+		int t = tables.twist_move[twist * FACE_MOVE_COUNT + m];
+		if (tables.twist_prune[comb * TWIST_COUNT + t] > togo - 1) continue;
+		int f = tables.flip_move[flip * FACE_MOVE_COUNT + m];
+		if (tables.flip_prune[comb * FLIP_COUNT + f] > togo - 1) continue;
+		if (tables.twist_flip_prune[t * FLIP_COUNT + f] > togo - 1) continue;
+
+		path[depth] = m;
+		phase1(t, f, s, depth + 1, togo - 1);
+		if (done) return;
+	}
+}
+
+std::vector<int> solve(const CubeState& state, const SolveOptions& options) {
+	// TURN THE WHOLE CUBE SO THE CENTERS ARE HOME, THE SEARCH ONLY KNOWS FACE MOVES
+	const std::array<CubeState, ORIENTATION_COUNT>& all = orientations();
+	int rotation = 0;
+	for (int o = 0; o < ORIENTATION_COUNT; o++) {
+		if (multiply(state, all[o]).centers == CubeState().centers) rotation = o;
+	}
+
+	CubeState start = multiply(state, all[rotation]);
+	if (start == CubeState()) return {};
+
+	// ORIENTATION r SEARCHES r' * start * r, WHOSE SOLUTION TURNED BACK BY r SOLVES start
+	std::vector<Direction> directions;
+	for (int r : {0, rotation_orientation(MOVE_Z), rotation_orientation(MOVE_X)}) {
+		CubeState turned = multiply(multiply(all[orientation_inverse(r)], start), all[r]);
+		for (bool inverse : {false, true}) {
+			Direction d;
+			d.rotation = r;
+			d.inverse = inverse;
+			d.start = inverse ? invert(turned) : turned;
+			d.twist = get_twist(d.start);
+			d.flip = get_flip(d.start);
+			d.slice = get_slice(d.start);
+			int comb = d.slice / SLICE_PERM_COUNT;
+			d.lower = std::max(tables.twist_prune[comb * TWIST_COUNT + d.twist], tables.flip_prune[comb * FLIP_COUNT + d.flip]);
+			directions.push_back(d);
+		}
+	}
+	int lower = MAX_PHASE1;
+	for (const Direction& d : directions) lower = std::min(lower, d.lower);
+
+	Search search;
+	search.target_length = options.target_length;
+	search.deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(options.timeout_seconds));
+	for (int phase2_limit : {QUICK_PHASE2, MAX_PHASE2}) {
+		search.phase2_limit = phase2_limit;
+		// ALL DIRECTIONS GO ONE PHASE 1 DEPTH AT A TIME SO NONE GETS AHEAD OF THE OTHERS
+		for (int depth = lower; depth <= MAX_PHASE1 && depth < search.best_length && !search.done; depth++) {
+			for (const Direction& d : directions) {
+				if (depth < d.lower || depth >= search.best_length || search.done) continue;
+				search.direction = &d;
+				search.phase1(d.twist, d.flip, d.slice, 0, depth);
+			}
+		}
+		if (!search.best.empty()) break;
+	}
+
+	// MOVES FOUND FOR THE TURNED CUBE ARE MAPPED BACK TO THE FACES THEY LAND ON WHEN THE CUBE IS NOT TURNED
+	std::vector<int> result;
+	for (int m : search.best) result.push_back(conjugate_move(rotation, m));
+	return result;
+}
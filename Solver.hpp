@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CubeState.hpp"
+
+// TWO-PHASE (KOCIEMBA) SOLVER OVER COORDINATES OF THE CUBIE MODEL
+// PHASE 1 REACHES THE SUBGROUP <U, D, R2, L2, F2, B2> (NO TWIST, NO FLIP, SLICE EDGES IN THE SLICE)
+// PHASE 2 SOLVES THE REST USING ONLY MOVES OF THAT SUBGROUP
+
+struct SolveOptions {
+	// STOP SEARCHING ONCE A SOLUTION THIS SHORT (HALF TURN METRIC) IS FOUND
+	int target_length = 20;
+
+	// AFTER THIS LONG THE BEST SOLUTION FOUND SO FAR IS RETURNED (THE FIRST ONE IS ALWAYS WAITED FOR)
+	// WITH THESE DEFAULTS ABOUT 9 IN 10 RANDOM CUBES MEET THE TARGET, MOST WITHIN A FEW MS (SEE --bench --solver)
+	double timeout_seconds = 0.05;
+};
+
+// CACHE FILE UNDER $XDG_CACHE_HOME (OR ~/.cache) THE TABLES ARE MEMORY MAPPED FROM
+std::string default_solver_cache_path();
+
+// MAPS THE MOVE AND PRUNING TABLES FROM cache_path, GENERATING AND SAVING THEM FIRST IF THE FILE IS MISSING OR STALE
+// MUST BE CALLED (AND RETURN TRUE) BEFORE solve, NOT THREAD SAFE, LATER CALLS ARE NO-OPS
+bool load_solver_tables(const std::string& cache_path);
+
+// FACE MOVES (INDICES AS IN CubeState.hpp) THAT SOLVE state IN WHATEVER WHOLE CUBE ORIENTATION IT IS IN
+// EMPTY IF ALREADY SOLVED, SAFE TO CALL FROM SEVERAL THREADS AT ONCE
+std::vector<int> solve(const CubeState& state, const SolveOptions& options = SolveOptions());
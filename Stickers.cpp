@@ -0,0 +1,224 @@
+#include <cctype>
+#include "Stickers.hpp"
+
+namespace {
+struct Vec3i {
+	int x, y, z;
+	bool operator==(const Vec3i&) const = default;
+};
+}
+
+// OUTWARD NORMAL OF EACH FACE
+static constexpr Vec3i face_axis[6] = {{0, 1, 0}, {1, 0, 0}, {0, 0, 1}, {0, -1, 0}, {-1, 0, 0}, {0, 0, -1}};
+
+// POSITION (TWICE THE OFFSET FROM THE CUBE CENTER, SO ALWAYS AN INTEGER) AND OUTWARD NORMAL OF A STICKER
+static constexpr void sticker_geometry(int s, Vec3i& pos, Vec3i& normal) {
+	const int m = CUBE_N - 1;
+	int r = 2 * (s % (CUBE_N * CUBE_N) / CUBE_N) - m;
+	int c = 2 * (s % CUBE_N) - m;
+	switch (s / (CUBE_N * CUBE_N)) {
+		case FACE_U: pos = {c, m, r}; break;
+		case FACE_R: pos = {m, -r, -c}; break;
+		case FACE_F: pos = {c, -r, m}; break;
+		case FACE_D: pos = {c, -m, -r}; break;
+		case FACE_L: pos = {-m, -r, c}; break;
+		default:     pos = {-c, -r, -m}; break;
+	}
+	normal = face_axis[s / (CUBE_N * CUBE_N)];
+}
+
+// THE INVERSE OF sticker_geometry, -1 IF NO STICKER SITS THERE
+static constexpr int sticker_from_geometry(Vec3i pos, Vec3i normal) {
+	const int m = CUBE_N - 1;
+	int face = 0;
+	while (face < 6 && !(face_axis[face] == normal)) face++;
+	if (face == 6 || normal.x * pos.x + normal.y * pos.y + normal.z * pos.z != m) return -1;
+
+	int r = 0, c = 0;
+	switch (face) {
+		case FACE_U: r = pos.z; c = pos.x; break;
+		case FACE_R: r = -pos.y; c = -pos.z; break;
+		case FACE_F: r = -pos.y; c = pos.x; break;
+		case FACE_D: r = -pos.z; c = pos.x; break;
+		case FACE_L: r = -pos.y; c = pos.z; break;
+		default:     r = -pos.y; c = -pos.x; break;
+	}
+	if (r < -m || r > m || c < -m || c > m || (r + m) % 2 || (c + m) % 2) return -1;
+	return face * CUBE_N * CUBE_N + (r + m) / 2 * CUBE_N + (c + m) / 2;
+}
+
+int sticker_at(int x, int y, int z, int nx, int ny, int nz) {
+	const int m = CUBE_N - 1;
+	return sticker_from_geometry({2 * x - m, 2 * y - m, 2 * z - m}, {nx, ny, nz});
+}
+
+// CLOCKWISE QUARTER TURN SEEN FROM THE TIP OF axis: v' = a(a.v) - a x v
+static constexpr Vec3i rotate_quarter(Vec3i v, Vec3i a) {
+	int d = a.x * v.x + a.y * v.y + a.z * v.z;
+	Vec3i c = {a.y * v.z - a.z * v.y, a.z * v.x - a.x * v.z, a.x * v.y - a.y * v.x};
+	return {a.x * d - c.x, a.y * d - c.y, a.z * d - c.z};
+}
+
+// ONE TABLE PER FACE, DEPTH (WHOLE CUBE LAST) AND QUARTER TURN COUNT, turned[i] = stickers[permutation[i]]
+// (PLAIN ARRAYS, THE COMPILER FILLS THEM NOTICEABLY FASTER THAN std::array)
+constexpr int PERMUTATION_COUNT = 6 * (TURN_DEPTHS + 1) * 3;
+
+struct StickerPermutations {
+	uint16_t table[PERMUTATION_COUNT][STICKER_COUNT];
+};
+
+static constexpr int permutation_index(int face, int depth, int quarters) {
+	return (face * (TURN_DEPTHS + 1) + depth) * 3 + quarters - 1;
+}
+
+// BUILT BY THE COMPILER BY TURNING THE STICKER GEOMETRY IN 3D, ONE PASS OVER THE STICKERS PER FACE FILLS THE QUARTER
+// TURN OF THE LAYER EACH STICKER IS IN AND THE WHOLE CUBE QUARTER TURN (READ ONLY DATA, ABOUT 74 KB ON A 7x7x7)
+static constexpr StickerPermutations move_permutations = [] {
+	StickerPermutations permutations{};
+	auto& t = permutations.table;
+	for (int face = 0; face < 6; face++) {
+		Vec3i axis = face_axis[face];
+		for (int depth = 0; depth <= TURN_DEPTHS; depth++) {
+			uint16_t* quarter = t[permutation_index(face, depth, 1)];
+			for (int s = 0; s < STICKER_COUNT; s++) quarter[s] = (uint16_t)s;
+		}
+		for (int s = 0; s < STICKER_COUNT; s++) {
+			Vec3i pos, normal;
+			sticker_geometry(s, pos, normal);
+			int target = sticker_from_geometry(rotate_quarter(pos, axis), rotate_quarter(normal, axis));
+			int depth = (CUBE_N - 1 - (axis.x * pos.x + axis.y * pos.y + axis.z * pos.z)) / 2;
+			if (depth < TURN_DEPTHS) t[permutation_index(face, depth, 1)][target] = (uint16_t)s;
+			t[permutation_index(face, TURN_DEPTHS, 1)][target] = (uint16_t)s;
+		}
+
+		// HALF AND THREE QUARTER TURNS BY REPEATING THE QUARTER TURN
+		for (int depth = 0; depth <= TURN_DEPTHS; depth++) {
+			const uint16_t* quarter = t[permutation_index(face, depth, 1)];
+			for (int q = 2; q <= 3; q++) {
+				const uint16_t* previous = t[permutation_index(face, depth, q - 1)];
+				uint16_t* p = t[permutation_index(face, depth, q)];
+				for (int s = 0; s < STICKER_COUNT; s++) p[s] = previous[quarter[s]];
+			}
+		}
+	}
+	return permutations;
+}();
+
+// EVERY QUARTER TURN MOVES EACH STICKER TO EXACTLY ONE PLACE, AND UNDOING IT WITH THE THREE QUARTER TURN (ITS INVERSE)
+// PUTS EVERY STICKER BACK, SO FOUR QUARTER TURNS ARE THE IDENTITY
+static constexpr bool quarter_turns_invert() {
+	for (int face = 0; face < 6; face++) {
+		for (int depth = 0; depth <= TURN_DEPTHS; depth++) {
+			const uint16_t* quarter = move_permutations.table[permutation_index(face, depth, 1)];
+			const uint16_t* inverse = move_permutations.table[permutation_index(face, depth, 3)];
+			for (int s = 0; s < STICKER_COUNT; s++) {
+				if (quarter[inverse[s]] != s) return false;
+			}
+		}
+	}
+	return true;
+}
+static_assert(quarter_turns_invert(), "every quarter turn must be a permutation of order 4");
+
+// A LAYER TURNED FROM ONE FACE IS THE SAME LAYER TURNED THE OTHER WAY FROM THE OPPOSITE FACE (WHOLE CUBE TOO)
+static constexpr bool opposite_faces_agree() {
+	for (int face = 0; face < 3; face++) {
+		for (int depth = 0; depth <= TURN_DEPTHS; depth++) {
+			int opposite = depth == TURN_DEPTHS ? TURN_DEPTHS : CUBE_N - 1 - depth;
+			if (opposite >= TURN_DEPTHS && depth != TURN_DEPTHS) continue;
+			for (int q = 1; q <= 3; q++) {
+				const uint16_t* turn = move_permutations.table[permutation_index(face, depth, q)];
+				const uint16_t* other = move_permutations.table[permutation_index(face + 3, opposite, 4 - q)];
+				for (int s = 0; s < STICKER_COUNT; s++) {
+					if (turn[s] != other[s]) return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+static_assert(opposite_faces_agree(), "opposite faces must turn their shared layers the opposite way");
+
+static const uint16_t* move_permutation(const Move& move) {
+	int depth = move.depth == WHOLE_CUBE ? TURN_DEPTHS : move.depth;
+	return move_permutations.table[permutation_index(move.face, depth, move.quarters)];
+}
+
+Stickers solved_stickers() {
+	Stickers s;
+	for (int i = 0; i < STICKER_COUNT; i++) s[i] = (uint8_t)(i / (CUBE_N * CUBE_N));
+	return s;
+}
+
+void apply_move(Stickers& stickers, const Move& move) {
+	const uint16_t* p = move_permutation(move);
+	Stickers turned;
+	for (int i = 0; i < STICKER_COUNT; i++) turned[i] = stickers[p[i]];
+	stickers = turned;
+}
+
+bool is_solved(const Stickers& stickers) {
+	for (int i = 0; i < STICKER_COUNT; i++) {
+		if (stickers[i] != stickers[i - i % (CUBE_N * CUBE_N)]) return false;
+	}
+	return true;
+}
+
+bool to_cube_state(const Stickers& stickers, CubeState& state) {
+#if CUBE_SIZE == 3
+	state = from_facelets(stickers);
+	return true;
+#else
+	(void)stickers;
+	(void)state;
+	return false;
+#endif
+}
+
+Move inverse_move(const Move& move) {
+	Move inverse = move;
+	inverse.quarters = (uint8_t)(4 - move.quarters);
+	return inverse;
+}
+
+Move move_from_index(int move) {
+	static const uint8_t rotation_face[3] = {FACE_R, FACE_U, FACE_F};
+	if (move >= MOVE_X) return {rotation_face[(move - MOVE_X) / 3], WHOLE_CUBE, (uint8_t)(move % 3 + 1)};
+	return {(uint8_t)(move / 3), 0, (uint8_t)(move % 3 + 1)};
+}
+
+void append_move(std::string& out, const Move& move) {
+	static const char face_letters[] = "urfdlb";
+	static const char rotation_letters[] = "yxzyxz"; // BY FACE, OPPOSITE FACES TURN THE OTHER WAY
+	char letter = move.depth == WHOLE_CUBE ? rotation_letters[move.face] : face_letters[move.face];
+	int quarters = move.depth == WHOLE_CUBE && move.face >= 3 ? 4 - move.quarters : move.quarters;
+
+	for (int i = 0; i < (quarters == 2 ? 2 : 1); i++) {
+		if (move.depth > 0) out += (char)('1' + move.depth);
+		out += quarters == 3 ? (char)std::toupper(letter) : letter;
+	}
+}
+
+bool read_move(const std::string& text, size_t& at, Move& move) {
+	size_t i = at;
+	int depth = 0;
+	if (i < text.size() && text[i] >= '2' && text[i] <= '9') {
+		depth = text[i] - '1';
+		if (depth >= TURN_DEPTHS) return false;
+		i++;
+	}
+	if (i >= text.size()) return false;
+
+	int index = move_from_char(text[i]);
+	if (index < 0 || (depth > 0 && index >= MOVE_X)) return false;
+	move = move_from_index(index);
+	if (depth > 0) move.depth = (int8_t)depth;
+	at = i + 1;
+	return true;
+}
+
+bool last_move(const std::string& text, Move& move) {
+	if (text.empty()) return false;
+	size_t at = text.size() >= 2 && std::isdigit((unsigned char)text[text.size() - 2]) ? text.size() - 2 : text.size() - 1;
+	return read_move(text, at, move);
+}
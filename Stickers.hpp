@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include "CubeSize.hpp"
+#include "CubeState.hpp"
+
+// LOGICAL STATE OF THE CUBE AT ANY SIZE: THE COLOR (Face) OF EVERY STICKER
+// FACE f, ROW r, COLUMN c IS AT f * CUBE_N * CUBE_N + r * CUBE_N + c, LAID OUT LIKE THE 3x3 Facelets (U R F D L B,
+// EACH FACE READ AS SEEN FROM OUTSIDE WITH U ON TOP, U ITSELF WITH B ON TOP AND D WITH F ON TOP)
+using Stickers = std::array<uint8_t, STICKER_COUNT>;
+
+// A TURN OF ONE LAYER, OR OF THE WHOLE CUBE, CLOCKWISE SEEN FROM face
+// depth 0 IS THE OUTER LAYER, INNER LAYERS GO UP TO TURN_DEPTHS - 1
+struct Move {
+	uint8_t face = FACE_U;
+	int8_t depth = 0;
+	uint8_t quarters = 1; // 1..3
+	bool operator==(const Move&) const = default;
+};
+
+// depth OF A WHOLE CUBE ROTATION (x TURNS WITH R, y WITH U, z WITH F)
+constexpr int8_t WHOLE_CUBE = -1;
+
+Stickers solved_stickers();
+
+// APPLIES A MOVE USING THE PERMUTATION TABLES GENERATED (ONCE) FOR THIS CUBE SIZE
+void apply_move(Stickers& stickers, const Move& move);
+
+// TRUE IF EVERY FACE SHOWS A SINGLE COLOR (ANY WHOLE CUBE ORIENTATION)
+bool is_solved(const Stickers& stickers);
+
+// STICKER ON GRID SLOT (x, y, z) (0 .. CUBE_N - 1 ON EACH AXIS) FACING ALONG normal, -1 IF NONE
+int sticker_at(int x, int y, int z, int nx, int ny, int nz);
+
+// CUBIE STATE FOR THE 3x3 SOLVER, FALSE ON ANY OTHER SIZE
+bool to_cube_state(const Stickers& stickers, CubeState& state);
+
+Move inverse_move(const Move& move);
+
+// MOVE FOR A MOVE INDEX OF CubeState.hpp
+Move move_from_index(int move);
+
+// MOVE LIST NOTATION: udrlfbxyz CLOCKWISE, UPPERCASE COUNTER CLOCKWISE, A LAYER DIGIT (2 = FIRST INNER LAYER)
+// IN FRONT OF A FACE LETTER TURNS AN INNER LAYER, A HALF TURN IS WRITTEN AS TWO QUARTER TURNS
+void append_move(std::string& out, const Move& move);
+
+// READS THE MOVE STARTING AT text[at] AND ADVANCES at PAST IT, FALSE (at UNCHANGED) IF IT IS NOT A VALID MOVE
+bool read_move(const std::string& text, size_t& at, Move& move);
+
+// LAST MOVE WRITTEN IN text, FALSE IF text DOES NOT END IN A MOVE
+bool last_move(const std::string& text, Move& move);
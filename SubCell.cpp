@@ -0,0 +1,163 @@
+#include <cstring>
+#include "SubCell.hpp"
+
+static_assert(sizeof(Cell) == 4, "resolve_row_sse2 loads cells as 32 bit lanes");
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define SUBCELL_SSE2 1
+#endif
+
+const char* cell_mode_name(CellMode mode) {
+	switch (mode) {
+		case CellMode::Full: return "full";
+		case CellMode::Half: return "half";
+		case CellMode::Quad: return "quad";
+	}
+	return "?";
+}
+
+bool parse_cell_mode(const char* name, CellMode& mode) {
+	for (CellMode candidate : {CellMode::Full, CellMode::Half, CellMode::Quad}) {
+		if (std::strcmp(name, cell_mode_name(candidate)) == 0) {
+			mode = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+int cell_columns(CellMode mode) {
+	return mode == CellMode::Quad ? 2 : 1;
+}
+
+int cell_rows(CellMode mode) {
+	return mode == CellMode::Full ? 1 : 2;
+}
+
+// ONE CELL FROM ITS SAMPLES IN QUADRANT ORDER (A HALF BLOCK CELL PASSES EACH OF ITS TWO SAMPLES TWICE)
+// SAMPLES ARE BLANK OR '@' IN SOME COLOR, THE FIRST COLOR FOUND WINS A TIE
+static Cell resolve_cell(const Cell* s[4]) {
+	uint8_t covered = 0;
+	for (int i = 0; i < 4; i++) {
+		if (s[i]->glyph != ' ') covered |= 1 << i;
+	}
+	if (covered == 0) return Cell();
+
+	uint8_t count[4] = {};
+	int foreground = -1;
+	for (int i = 0; i < 4; i++) {
+		if (!(covered & 1 << i)) continue;
+		for (int j = 0; j <= i; j++) {
+			if ((covered & 1 << j) && s[j]->color == s[i]->color) {
+				if (++count[j] > (foreground < 0 ? 0 : count[foreground])) foreground = j;
+				break;
+			}
+		}
+	}
+
+	Cell cell;
+	cell.color = s[foreground]->color;
+
+	// EMPTY SAMPLES NEED THE TERMINAL BACKGROUND, SO EVERY COVERED ONE IS DRAWN IN THE FOREGROUND COLOR
+	if (covered != GLYPH_QUADRANTS) {
+		cell.glyph = (char)covered;
+		return cell;
+	}
+
+	uint8_t quadrants = 0;
+	int background = -1;
+	uint8_t other[4] = {};
+	for (int i = 0; i < 4; i++) {
+		if (s[i]->color == cell.color) {
+			quadrants |= 1 << i;
+			continue;
+		}
+		for (int j = 0; j <= i; j++) {
+			if (s[j]->color == s[i]->color) {
+				if (++other[j] > (background < 0 ? 0 : other[background])) background = j;
+				break;
+			}
+		}
+	}
+	cell.glyph = (char)quadrants;
+	if (background >= 0) {
+		cell.glyph = (char)(quadrants | GLYPH_BACKGROUND);
+		cell.background = s[background]->color;
+	}
+	return cell;
+}
+
+// SCALAR CELLS first .. last - 1 OF ROW y
+static void resolve_span(const Framebuffer& samples, CellMode mode, Framebuffer& screen, int y, int first, int last) {
+	int columns = cell_columns(mode);
+	const Cell* top = samples.row(y * 2);
+	const Cell* bottom = samples.row(y * 2 + 1);
+	Cell* out = screen.row(y);
+	for (int x = first; x < last; x++) {
+		const Cell* s[4] = {&top[x * columns], &top[x * columns + columns - 1], &bottom[x * columns], &bottom[x * columns + columns - 1]};
+		out[x] = resolve_cell(s);
+	}
+}
+
+#ifdef SUBCELL_SSE2
+// 4 CELLS PER STEP: WHERE EVERY SAMPLE IS THE SAME 4 BYTE CELL (INSIDE A STICKER OR THE EMPTY BACKGROUND, MOST OF
+// THE SCREEN) THE CELL IS A BLANK OR A FULL BLOCK, COMPUTED IN REGISTERS, THE REST (EDGES) GO THROUGH resolve_cell
+static void resolve_row_sse2(const Framebuffer& samples, CellMode mode, Framebuffer& screen, int y) {
+	const Cell* top = samples.row(y * 2);
+	const Cell* bottom = samples.row(y * 2 + 1);
+	Cell* out = screen.row(y);
+
+	// A CELL IS glyph | color << 8 | bold << 16 | background << 24 ON LITTLE ENDIAN TARGETS
+	const __m128i glyph_byte = _mm_set1_epi32(0xff);
+	const __m128i color_byte = _mm_set1_epi32(0xff00);
+	const __m128i blank = _mm_set1_epi32(' ');
+	const __m128i full_block = _mm_set1_epi32(GLYPH_QUADRANTS);
+
+	int x = 0;
+	for (; x + 4 <= screen.width; x += 4) {
+		__m128i same;
+		__m128i first;
+		if (mode == CellMode::Quad) {
+			// EVEN SAMPLES ARE THE LEFT QUADRANTS, ODD ONES THE RIGHT
+			__m128 t0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(top + x * 2)));
+			__m128 t1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(top + x * 2 + 4)));
+			__m128 b0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(bottom + x * 2)));
+			__m128 b1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(bottom + x * 2 + 4)));
+			first = _mm_castps_si128(_mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+			__m128i top_right = _mm_castps_si128(_mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1)));
+			__m128i bottom_left = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)));
+			__m128i bottom_right = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)));
+			same = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi32(first, top_right), _mm_cmpeq_epi32(first, bottom_left)),
+				_mm_cmpeq_epi32(first, bottom_right));
+		} else {
+			first = _mm_loadu_si128((const __m128i*)(top + x));
+			same = _mm_cmpeq_epi32(first, _mm_loadu_si128((const __m128i*)(bottom + x)));
+		}
+
+		// BLANK SAMPLES STAY THE BLANK CELL, COVERED ONES BECOME A FULL BLOCK IN THEIR COLOR
+		__m128i is_blank = _mm_cmpeq_epi32(_mm_and_si128(first, glyph_byte), blank);
+		__m128i block = _mm_or_si128(_mm_and_si128(first, color_byte), full_block);
+		__m128i cells = _mm_or_si128(_mm_and_si128(is_blank, first), _mm_andnot_si128(is_blank, block));
+		_mm_storeu_si128((__m128i*)(out + x), cells);
+
+		int mixed = ~_mm_movemask_ps(_mm_castsi128_ps(same)) & 0xf;
+		while (mixed) {
+			int i = __builtin_ctz(mixed);
+			resolve_span(samples, mode, screen, y, x + i, x + i + 1);
+			mixed &= mixed - 1;
+		}
+	}
+	resolve_span(samples, mode, screen, y, x, screen.width);
+}
+#endif
+
+void resolve_subcells(const Framebuffer& samples, CellMode mode, Framebuffer& screen) {
+	for (int y = 0; y < screen.height; y++) {
+#ifdef SUBCELL_SSE2
+		resolve_row_sse2(samples, mode, screen, y);
+#else
+		resolve_span(samples, mode, screen, y, 0, screen.width);
+#endif
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Framebuffer.hpp"
+
+// HOW MANY SAMPLES EVERY TERMINAL CELL IS RASTERIZED FROM
+// FULL: ONE ('@' CELLS), HALF: TWO STACKED (HALF BLOCKS), QUAD: 2x2 (QUADRANT BLOCKS)
+// A HALF SAMPLE IS ROUGHLY SQUARE AND A QUAD SAMPLE HAS THE SHAPE OF A CELL, SO THE PROJECTION NEVER CHANGES
+enum class CellMode { Full, Half, Quad };
+
+const char* cell_mode_name(CellMode mode);
+
+// FALSE FOR AN UNKNOWN NAME
+bool parse_cell_mode(const char* name, CellMode& mode);
+
+// SAMPLES PER CELL ACROSS AND DOWN
+int cell_columns(CellMode mode);
+int cell_rows(CellMode mode);
+
+// TURNS samples (cell_columns x cell_rows SAMPLES PER CELL) INTO screen, WHICH MUST ALREADY HAVE THE CELL SIZE
+// THE MOST COMMON COLOR OF A CELL BECOMES ITS FOREGROUND, A CELL WITH EMPTY SAMPLES KEEPS THE TERMINAL BACKGROUND
+// BEHIND THEM, A FULL ONE TAKES THE NEXT MOST COMMON COLOR AS ITS BACKGROUND
+void resolve_subcells(const Framebuffer& samples, CellMode mode, Framebuffer& screen);
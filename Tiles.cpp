@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include "Tiles.hpp"
+
+TileRasterizer::~TileRasterizer() {
+	stop_workers();
+}
+
+void TileRasterizer::stop_workers() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers) worker.join();
+	workers.clear();
+	stopping = false;
+}
+
+void TileRasterizer::set_threads(int count) {
+	count = std::max(1, count);
+	if (count == threads()) return;
+	stop_workers();
+	for (int i = 1; i < count; i++) {
+		workers.emplace_back(&TileRasterizer::worker_loop, this);
+	}
+}
+
+// WORKERS SLEEP UNTIL A NEW GENERATION (FRAME) IS PUBLISHED, HELP WITH ITS TILES, THEN REPORT BACK
+void TileRasterizer::worker_loop() {
+	uint64_t seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+		}
+
+		run_tiles();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finished++;
+		}
+		done.notify_one();
+	}
+}
+
+// CLAIMS TILES UNTIL NONE ARE LEFT, EACH TILE IS DRAWN BY EXACTLY ONE THREAD
+void TileRasterizer::run_tiles() {
+	Framebuffer& screen = *job_screen;
+	ZBuffer& zbuffer = *job_zbuffer;
+	const std::vector<ScreenTriangle>& triangles = *job_triangles;
+	RasterCounts counts;
+
+	while (true) {
+		int claimed = next_tile.fetch_add(1, std::memory_order_relaxed);
+		if (claimed >= (int)busy_tiles.size()) break;
+
+		int tile = busy_tiles[claimed];
+		int tx = tile % tiles_x;
+		int ty = tile / tiles_x;
+		TileRect clip = {
+			tx * TILE_WIDTH,
+			ty * TILE_HEIGHT,
+			std::min(screen.width, (tx + 1) * TILE_WIDTH) - 1,
+			std::min(screen.height, (ty + 1) * TILE_HEIGHT) - 1,
+		};
+		for (uint32_t index : bins[tile]) {
+			fill_triangle(triangles[index], clip, screen, zbuffer, counts);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	job_counts->add(counts);
+}
+
+void TileRasterizer::rasterize(const std::vector<ScreenTriangle>& triangles, Framebuffer& screen, ZBuffer& zbuffer, RasterCounts& counts) {
+	int width = screen.width;
+	int height = screen.height;
+
+	// SINGLE THREAD: ONE PASS OVER THE WHOLE SCREEN, NO BINNING
+	if (workers.empty()) {
+		TileRect full = {0, 0, width - 1, height - 1};
+		for (const ScreenTriangle& triangle : triangles) {
+			fill_triangle(triangle, full, screen, zbuffer, counts);
+		}
+		return;
+	}
+
+	// BINNING: EVERY TRIANGLE GOES TO EACH TILE ITS BOUNDING BOX OVERLAPS, IN SUBMISSION ORDER
+	tiles_x = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+	tiles_y = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+	if ((int)bins.size() < tiles_x * tiles_y) bins.resize(tiles_x * tiles_y);
+	for (std::vector<uint32_t>& bin : bins) bin.clear();
+
+	for (uint32_t i = 0; i < triangles.size(); i++) {
+		const ScreenTriangle& t = triangles[i];
+		float min_x = std::min({t.v[0].x, t.v[1].x, t.v[2].x});
+		float max_x = std::max({t.v[0].x, t.v[1].x, t.v[2].x});
+		float min_y = std::min({t.v[0].y, t.v[1].y, t.v[2].y});
+		float max_y = std::max({t.v[0].y, t.v[1].y, t.v[2].y});
+		if (!(max_x >= 0.0f && max_y >= 0.0f && min_x < (float)width && min_y < (float)height)) continue;
+
+		int tx0 = std::max(0, (int)std::floor(min_x) / TILE_WIDTH);
+		int tx1 = std::min(tiles_x - 1, (int)std::floor(max_x) / TILE_WIDTH);
+		int ty0 = std::max(0, (int)std::floor(min_y) / TILE_HEIGHT);
+		int ty1 = std::min(tiles_y - 1, (int)std::floor(max_y) / TILE_HEIGHT);
+		for (int ty = ty0; ty <= ty1; ty++) {
+			for (int tx = tx0; tx <= tx1; tx++) {
+				bins[ty * tiles_x + tx].push_back(i);
+			}
+		}
+	}
+
+	busy_tiles.clear();
+	for (int tile = 0; tile < tiles_x * tiles_y; tile++) {
+		if (!bins[tile].empty()) busy_tiles.push_back(tile);
+	}
+	if (busy_tiles.empty()) return;
+
+	// PUBLISH THE FRAME, HELP WITH THE TILES ON THIS THREAD, THEN WAIT FOR EVERY WORKER TO REPORT
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job_triangles = &triangles;
+		job_screen = &screen;
+		job_zbuffer = &zbuffer;
+		job_counts = &counts;
+		next_tile.store(0, std::memory_order_relaxed);
+		finished = 0;
+		generation++;
+	}
+	wake.notify_all();
+
+	run_tiles();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&] { return finished == (int)workers.size(); });
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Raster.hpp"
+
+// SCREEN TILE SIZE IN CELLS
+constexpr int TILE_WIDTH = 64;
+constexpr int TILE_HEIGHT = 16;
+static_assert(TILE_WIDTH % COARSE_WIDTH == 0 && TILE_HEIGHT % COARSE_HEIGHT == 0, "coarse depth blocks must not straddle tiles");
+
+// BINS TRIANGLES INTO SCREEN TILES AND RASTERIZES THE TILES ON A POOL OF WORKER THREADS
+// EVERY TILE OWNS ITS CELLS AND ZBUFFER SLICE, SO NO LOCKS ARE TAKEN WHILE RASTERIZING
+// TRIANGLES ARE DRAWN IN SUBMISSION ORDER WITHIN EACH TILE, MATCHING THE SINGLE THREADED OUTPUT EXACTLY
+struct TileRasterizer {
+	TileRasterizer() = default;
+	TileRasterizer(const TileRasterizer&) = delete;
+	TileRasterizer& operator=(const TileRasterizer&) = delete;
+	~TileRasterizer();
+
+	// TOTAL THREADS RASTERIZING (THE CALLING THREAD PLUS count - 1 WORKERS), 1 DISABLES TILING
+	void set_threads(int count);
+	int threads() const { return (int)workers.size() + 1; }
+
+	// ADDS THE WORK OF EVERY TILE TO counts
+	void rasterize(const std::vector<ScreenTriangle>& triangles, Framebuffer& screen, ZBuffer& zbuffer, RasterCounts& counts);
+
+	// TRIANGLE INDICES PER TILE, KEPT ACROSS FRAMES
+	int tiles_x = 0;
+	int tiles_y = 0;
+	std::vector<std::vector<uint32_t>> bins;
+	std::vector<int> busy_tiles;
+
+	// CURRENT JOB, VALID WHILE rasterize RUNS
+	const std::vector<ScreenTriangle>* job_triangles = nullptr;
+	Framebuffer* job_screen = nullptr;
+	ZBuffer* job_zbuffer = nullptr;
+	RasterCounts* job_counts = nullptr; // EACH THREAD ADDS ITS TOTAL UNDER mutex
+	std::atomic<int> next_tile{0};
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	uint64_t generation = 0;
+	int finished = 0;
+	bool stopping = false;
+
+	void stop_workers();
+	void worker_loop();
+	void run_tiles();
+};
@@ -0,0 +1,229 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+#include <array>
+#include <cmath>
+#include "Transform.hpp"
+#include "Render.hpp"
+
+// A ROTATION OF THE GRID WITH WHOLE ENTRIES, COLUMN c IS WHERE AXIS c GOES (THE LAYOUT OF glm::mat4)
+struct GridRotation {
+	int8_t m[3][3];
+
+	constexpr bool operator==(const GridRotation&) const = default;
+};
+
+static constexpr GridRotation operator*(const GridRotation& a, const GridRotation& b) {
+	GridRotation r{};
+	for (int c = 0; c < 3; c++) {
+		for (int i = 0; i < 3; i++) {
+			int sum = 0;
+			for (int k = 0; k < 3; k++) sum += a.m[k][i] * b.m[c][k];
+			r.m[c][i] = (int8_t)sum;
+		}
+	}
+	return r;
+}
+
+static constexpr Vec3i operator*(const GridRotation& a, const Vec3i& v) {
+	return {a.m[0][0] * v.x + a.m[1][0] * v.y + a.m[2][0] * v.z, a.m[0][1] * v.x + a.m[1][1] * v.y + a.m[2][1] * v.z,
+		a.m[0][2] * v.x + a.m[1][2] * v.y + a.m[2][2] * v.z};
+}
+
+// ONE QUARTER TURN ABOUT A COORDINATE AXIS MAPS v TO axis (axis . v) + axis x v, SO quarters OF THEM BUILD THE
+// ROTATION FROM ZEROS AND ONES WITH NO ROUNDING
+static constexpr GridRotation quarter_turn(const Vec3i& axis, int quarters) {
+	GridRotation quarter{};
+	for (int c = 0; c < 3; c++) {
+		Vec3i e = {c == 0, c == 1, c == 2};
+		int dot = axis.x * e.x + axis.y * e.y + axis.z * e.z;
+		quarter.m[c][0] = (int8_t)(axis.x * dot + axis.y * e.z - axis.z * e.y);
+		quarter.m[c][1] = (int8_t)(axis.y * dot + axis.z * e.x - axis.x * e.z);
+		quarter.m[c][2] = (int8_t)(axis.z * dot + axis.x * e.y - axis.y * e.x);
+	}
+	GridRotation turn = {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}};
+	for (int i = 0; i < (quarters % 4 + 4) % 4; i++) turn = quarter * turn;
+	return turn;
+}
+
+// THE 24 ORIENTATIONS OF A CUBE UNIT AS EXACT ROTATIONS, IDENTITY FIRST, READ ONLY DATA BUILT BY THE COMPILER
+// (A 25TH ORIENTATION WOULD INDEX PAST THE END, WHICH STOPS THE COMPILE)
+static constexpr std::array<GridRotation, 24> unit_orientations = [] {
+	constexpr Vec3i axes[3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+	std::array<GridRotation, 24> found{};
+	found[0] = quarter_turn(axes[0], 0);
+	int count = 1;
+	for (int i = 0; i < count; i++) {
+		for (const Vec3i& axis : axes) {
+			GridRotation next = quarter_turn(axis, 1) * found[i];
+			bool known = false;
+			for (int j = 0; j < count; j++) known = known || found[j] == next;
+			if (!known) found[count++] = next;
+		}
+	}
+	return found;
+}();
+
+static constexpr bool orientations_closed() {
+	for (const GridRotation& a : unit_orientations) {
+		for (const GridRotation& b : unit_orientations) {
+			bool known = false;
+			for (const GridRotation& c : unit_orientations) known = known || c == a * b;
+			if (!known) return false;
+		}
+	}
+	return true;
+}
+static_assert(orientations_closed(), "the 24 unit orientations must be closed under composition");
+
+static int orientation_index(const GridRotation& rotation) {
+	for (int o = 0; o < 24; o++) {
+		if (unit_orientations[o] == rotation) return o;
+	}
+	return 0;
+}
+
+static glm::mat4 orientation_matrix(int o) {
+	const GridRotation& r = unit_orientations[o];
+	glm::mat4 matrix(1.0f);
+	for (int c = 0; c < 3; c++) matrix[c] = glm::vec4(r.m[c][0], r.m[c][1], r.m[c][2], 0.0f);
+	return matrix;
+}
+
+// ADVANCES THE PROGRESS ONE SIMULATION STEP, speed s COVERS AS MUCH OF THE REMAINING TURN AS s NORMAL STEPS
+bool advance_transform(Transform& transform, double speed) {
+	if (transform.affected.empty()) return true;
+
+	// EASE OUT, EVERY NORMAL STEP COVERS A TENTH OF WHAT IS LEFT, THE LAST PERCENT IS TAKEN AT ONCE
+	double target = 1.0 - (1.0 - transform.progress) * std::pow(0.9, speed);
+	if (target > 0.99) target = 1.0;
+	transform.progress = target;
+	return transform.progress >= 1.0;
+}
+
+// MOVES THE UNITS OF A TURN THAT REACHED ITS END TO THEIR NEW GRID SLOT AND ORIENTATION (INTEGER ARITHMETIC ONLY)
+static void land_transform(Transform& transform, Cube& cube) {
+	Vec3i axis = {(int)std::lround(transform.axis.x), (int)std::lround(transform.axis.y), (int)std::lround(transform.axis.z)};
+	GridRotation turn = quarter_turn(axis, (int)transform.direction);
+	for (int16_t u : transform.affected) {
+		CubeUnit& unit = cube.units[u];
+
+		// OFFSETS FROM THE CENTER SLOT, DOUBLED SO THEY ARE WHOLE ON EVEN SIZED CUBES TOO
+		const int last = CUBE_N - 1;
+		Vec3i offset = turn * Vec3i{2 * unit.grid.x - last, 2 * unit.grid.y - last, 2 * unit.grid.z - last};
+		unit.grid = {(offset.x + last) / 2, (offset.y + last) / 2, (offset.z + last) / 2};
+
+		unit.orientation = (uint8_t)orientation_index(turn * unit_orientations[unit.orientation]);
+		unit.angle = 0.0f;
+		unit.position = unit_position(unit.grid);
+		unit.rotation = orientation_matrix(unit.orientation);
+	}
+	transform.affected.clear();
+}
+
+// STARTS ANIMATING move AND APPLIES IT TO THE LOGICAL STATE
+void start_transform(Transform& transform, Cube& cube, Stickers& state, const Move& move) {
+	// OUTWARD NORMAL OF EACH FACE (U R F D L B)
+	static const Vec3i face_normal[6] = {{0, 1, 0}, {1, 0, 0}, {0, 0, 1}, {0, -1, 0}, {-1, 0, 0}, {0, 0, -1}};
+
+	// RESET TRANSFORM AND APPLY THE MOVE TO THE LOGICAL STATE
+	transform.affected.clear();
+	transform.progress = 0.0;
+	transform.direction = move.quarters == 3 ? -1.0f : (float)move.quarters;
+	transform.turn_axis = move.face % 3;
+	apply_move(state, move);
+
+	// CLOCKWISE SEEN FROM THE FACE IS A POSITIVE ROTATION ABOUT THE INWARD NORMAL
+	Vec3i n = face_normal[move.face];
+	transform.axis = -glm::vec3((float)n.x, (float)n.y, (float)n.z);
+
+	// SELECT AFFECTED CUBE UNITS: THE LAYER move.depth SLOTS IN FROM THE FACE, OR ALL OF THEM
+	int layer = n.x + n.y + n.z > 0 ? CUBE_N - 1 - move.depth : move.depth;
+	// (BY THE CURRENT SLOT, A LANDED TURN ABOUT THE SAME AXIS MAY HAVE MOVED UNITS WITHIN THEIR LAYER)
+	for (int i = 0; i < SHELL_UNITS; i++) {
+		Vec3i g = cube.units[i].grid;
+		int coordinate = n.x != 0 ? g.x : n.y != 0 ? g.y : g.z;
+		if (move.depth == WHOLE_CUBE || coordinate == layer) {
+			transform.affected.push_back((int16_t)i);
+			cube.moving[i] = 1;
+		}
+	}
+}
+
+bool TurnAnimations::can_start(const Move& move) const {
+	for (const Transform& transform : slots) {
+		if (!transform.affected.empty() && transform.turn_axis != move.face % 3) return false;
+	}
+	return true;
+}
+
+void TurnAnimations::start(Cube& cube, Stickers& state, const Move& move) {
+	Transform* slot = nullptr;
+	for (Transform& transform : slots) {
+		if (transform.affected.empty()) {
+			slot = &transform;
+			break;
+		}
+	}
+	if (!slot) slot = &slots.emplace_back();
+	start_transform(*slot, cube, state, move);
+	running++;
+}
+
+void TurnAnimations::advance(Cube& cube, const Stickers& state, double speed) {
+	if (running == 0) return;
+	for (Transform& transform : slots) {
+		if (transform.affected.empty()) continue;
+		if (advance_transform(transform, speed)) {
+			land_transform(transform, cube);
+			running--;
+		}
+	}
+
+	// EVERYTHING LANDED, SNAP TO THE LOGICAL STATE
+	if (running == 0) {
+		sync_cube(cube, state);
+		return;
+	}
+
+	// IN FLIGHT ANGLES ARE SUMMED FROM THE PROGRESS OF EVERY RUNNING TURN (TWO TURNS OF ONE LAYER BOTH MOVE ITS UNITS,
+	// AND THEY ALL TURN ABOUT ONE COORDINATE AXIS SO THEIR ROTATIONS ADD UP), MEASURED ABOUT ITS POSITIVE DIRECTION
+	// (OPPOSITE FACES TURN ABOUT OPPOSITE NORMALS)
+	glm::vec3 axis(0.0f);
+	for (const Transform& transform : slots) {
+		for (int16_t u : transform.affected) cube.units[u].angle = 0.0f;
+	}
+	for (const Transform& transform : slots) {
+		if (transform.affected.empty()) continue;
+		float sign = transform.axis.x + transform.axis.y + transform.axis.z;
+		axis = transform.axis * sign;
+		float angle = (float)(sign * transform.direction * transform.progress * glm::half_pi<double>());
+		for (int16_t u : transform.affected) cube.units[u].angle += angle;
+	}
+
+	// POSE = IN FLIGHT ROTATION x RESTING POSE, THE ROTATION IS ONLY REBUILT WHEN THE ANGLE CHANGES (UNITS OF ONE
+	// SLICE SHARE IT, AND MUST END UP WITH IDENTICAL MATRICES)
+	float turn_angle = 0.0f;
+	glm::mat4 turn(1.0f);
+	for (const Transform& transform : slots) {
+		for (int16_t u : transform.affected) {
+			CubeUnit& unit = cube.units[u];
+			if (unit.angle != turn_angle) {
+				turn_angle = unit.angle;
+				turn = glm::rotate(glm::mat4(1.0f), turn_angle, axis);
+			}
+			unit.rotation = unit.orientation == 0 ? turn : turn * orientation_matrix(unit.orientation);
+			unit.position = glm::vec3(turn * glm::vec4(unit_position(unit.grid), 1.0f));
+		}
+	}
+}
+
+void TurnAnimations::finish(Cube& cube, const Stickers& state) {
+	if (running == 0) return;
+	for (Transform& transform : slots) {
+		transform.affected.clear();
+		transform.progress = 1.0;
+	}
+	running = 0;
+	sync_cube(cube, state);
+}
@@ -1,12 +1,45 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
 #include "CubeUnit.hpp"
+#include "Stickers.hpp"
 
+// ONE TURN IN FLIGHT, affected HOLDS THE INDICES OF THE CUBE UNITS IT MOVES AND IS EMPTY ONCE IT LANDED
 struct Transform {
-	std::vector<std::reference_wrapper<CubeUnit>> affected;
-	double progress = 0.0f;
+	std::vector<int16_t> affected;
+	double progress = 0.0;
 	glm::vec3 axis;
 	float direction = 1.0f;
+	uint8_t turn_axis = 0; // U/D, R/L OR F/B (move.face % 3)
+};
+
+// ADVANCES THE PROGRESS ONE SIMULATION STEP, speed s COVERS AS MUCH OF THE REMAINING TURN AS s NORMAL STEPS
+// RETURNS TRUE ONCE THE TURN REACHED ITS END (UNIT POSES ARE UPDATED BY TurnAnimations::advance)
+bool advance_transform(Transform& transform, double speed);
+
+// STARTS ANIMATING move AND APPLIES IT TO THE LOGICAL STATE
+void start_transform(Transform& transform, Cube& cube, Stickers& state, const Move& move);
+
+// TURNS ANIMATING AT THE SAME TIME, ALL ABOUT ONE AXIS SO THEY COMMUTE (DISJOINT LAYERS, OR ONE LAYER TWICE)
+// THE CUBE IS ONLY SNAPPED TO THE LOGICAL STATE ONCE THE LAST OF THEM LANDED, SO RUNNING TURNS ARE NEVER DISTURBED
+// FINISHED SLOTS ARE REUSED, STARTING A TURN DOES NOT ALLOCATE ONCE A FEW HAVE RUN
+struct TurnAnimations {
+	std::vector<Transform> slots;
+	int running = 0;
+
+	bool empty() const { return running == 0; }
+
+	// TRUE IF move CAN START NOW: NOTHING IS RUNNING OR EVERY RUNNING TURN IS ABOUT THE SAME AXIS
+	bool can_start(const Move& move) const;
+
+	// STARTS ANIMATING move AND APPLIES IT TO THE LOGICAL STATE, ONLY VALID IF can_start(move)
+	void start(Cube& cube, Stickers& state, const Move& move);
+
+	// ONE SIMULATION STEP OF EVERY RUNNING TURN, A TURN THAT LANDS MOVES ITS UNITS TO THEIR EXACT NEW RESTING POSE
+	void advance(Cube& cube, const Stickers& state, double speed);
+
+	// ENDS EVERY RUNNING TURN BY SNAPPING TO THE LOGICAL STATE
+	void finish(Cube& cube, const Stickers& state);
 };
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Wall.hpp"
+#include "CubeState.hpp"
+#include "Pacing.hpp"
+#include "Solver.hpp"
+
+// RANDOM SCRAMBLE LENGTH
+static const int WALL_SCRAMBLE_LENGTH = 20;
+
+// SIMULATION STEPS A SOLVED CUBE IS HELD BEFORE THE NEXT SCRAMBLE (HALF OF IT BETWEEN SCRAMBLE AND SOLUTION)
+static const int WALL_HOLD_STEPS = (int)(1.0 / SIM_STEP);
+
+// DISTANCE BETWEEN GRID SLOTS, CUBES ARE SCALED TO SPAN -1 .. 1 AND TILTED SO THEIR CORNERS STICK OUT A LITTLE
+static const float WALL_SPACING = 3.5f;
+
+bool CubeWall::setup(int count, const std::string& scramble_path, bool solver, uint32_t seed, std::string& error) {
+	if (count < 1 || count > WALL_MAX_CUBES) {
+		error = "--wall takes 1 to " + std::to_string(WALL_MAX_CUBES) + " cubes";
+		return false;
+	}
+
+	// ONE MOVE LIST PER LINE (SAME LETTERS AS THE MOVE LIST), EMPTY LINES ARE SKIPPED
+	scrambles.clear();
+	if (!scramble_path.empty()) {
+		std::ifstream input(scramble_path);
+		if (!input) {
+			error = "could not open " + scramble_path;
+			return false;
+		}
+		std::string line;
+		for (int number = 1; std::getline(input, line); number++) {
+			std::vector<Move> moves;
+			for (size_t at = 0; at < line.size();) {
+				if (std::strchr(" \t\r", line[at])) {
+					at++;
+					continue;
+				}
+				Move move;
+				if (!read_move(line, at, move)) {
+					error = scramble_path + ":" + std::to_string(number) + ": not a move at position " + std::to_string(at);
+					return false;
+				}
+				moves.push_back(move);
+			}
+			if (!moves.empty()) scrambles.push_back(moves);
+		}
+		if (scrambles.empty()) {
+			error = scramble_path + " holds no scrambles";
+			return false;
+		}
+	}
+
+	use_solver = solver && CUBE_N == 3 && load_solver_tables(default_solver_cache_path());
+	random.seed(seed);
+	next_scramble = 0;
+	solves = 0;
+
+	// STARTS ARE STAGGERED OVER A FEW SECONDS SO THE CUBES DO NOT TURN IN LOCKSTEP
+	cubes = std::vector<WallCube>(count);
+	std::uniform_int_distribution<> stagger(0, 3 * WALL_HOLD_STEPS);
+	for (WallCube& wall_cube : cubes) wall_cube.wait = stagger(random);
+	return true;
+}
+
+void CubeWall::layout(const glm::mat4& proj) {
+	int count = (int)cubes.size();
+
+	// THE VIEW IS proj[1][1] / proj[0][0] TIMES AS WIDE AS TALL, THE GRID GETS ROUGHLY THE SAME SHAPE
+	float aspect = proj[1][1] / proj[0][0];
+	columns = std::clamp((int)std::lround(std::sqrt(count * aspect)), 1, count);
+	rows = (count + columns - 1) / columns;
+
+	// EVERY CUBE IS SHOWN FROM THE RESTING VIEW OF THE SINGLE CUBE WHILE THE WALL ITSELF FACES THE CAMERA
+	const CubeMesh& mesh = cube_mesh();
+	glm::mat4 tilt = glm::rotate(glm::mat4(1.0f), PITCH_ISO, glm::vec3(1, 0, 0));
+	tilt = glm::rotate(tilt, -YAW_ISO, glm::vec3(0, 1, 0));
+	tilt = glm::scale(tilt, glm::vec3(1.0f / mesh.extent));
+	for (int i = 0; i < count; i++) {
+		float x = (i % columns - 0.5f * (columns - 1)) * WALL_SPACING;
+		float y = (0.5f * (rows - 1) - i / columns) * WALL_SPACING;
+		cubes[i].session.cube.model = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.0f)) * tilt;
+	}
+}
+
+float CubeWall::camera_distance(const glm::mat4& proj) const {
+	// A GRID EDGE PROJECTS INSIDE THE VIEW ONCE ITS DISTANCE FROM THE CENTER TIMES proj[i][i] IS WITHIN THE DEPTH,
+	// MEASURED TO THE FRONT OF THE CUBES, PLUS A LITTLE MARGIN SO THE OUTER CUBES DO NOT TOUCH THE EDGE
+	float half_width = 0.5f * columns * WALL_SPACING;
+	float half_height = 0.5f * rows * WALL_SPACING;
+	return 1.1f * std::max(half_width * proj[0][0], half_height * proj[1][1]) + std::sqrt(3.0f);
+}
+
+// A SOLVED CUBE GETS A NEW SCRAMBLE, A SCRAMBLED ONE ITS SOLUTION
+static void next_script(CubeWall& wall, WallCube& wall_cube) {
+	std::vector<Move> script;
+	if (!wall_cube.solving && !wall_cube.script.empty()) {
+		CubeState state;
+		if (wall.use_solver && to_cube_state(wall_cube.session.cube_state, state)) {
+			// THE FIRST SOLUTION FOUND IS GOOD ENOUGH, A STEP MUST NOT WAIT ON A LONG SEARCH
+			SolveOptions options;
+			options.target_length = 30;
+			options.timeout_seconds = 0.0;
+			for (int move : solve(state, options)) script.push_back(move_from_index(move));
+		} else {
+			for (auto move = wall_cube.script.rbegin(); move != wall_cube.script.rend(); move++) {
+				script.push_back(inverse_move(*move));
+			}
+		}
+		wall_cube.solving = true;
+	} else {
+		if (wall_cube.solving) wall.solves++;
+		if (!wall.scrambles.empty()) {
+			script = wall.scrambles[wall.next_scramble];
+			wall.next_scramble = (wall.next_scramble + 1) % wall.scrambles.size();
+		} else {
+			// NO FACE TWICE IN A ROW, SO NO TWO MOVES CANCEL OR MERGE
+			std::uniform_int_distribution<> face(0, 5);
+			std::uniform_int_distribution<> depth(0, TURN_DEPTHS - 1);
+			std::uniform_int_distribution<> quarters(1, 3);
+			while ((int)script.size() < WALL_SCRAMBLE_LENGTH) {
+				Move move = {(uint8_t)face(wall.random), (int8_t)depth(wall.random), (uint8_t)quarters(wall.random)};
+				if (script.empty() || move.face != script.back().face) script.push_back(move);
+			}
+		}
+		wall_cube.solving = false;
+	}
+	wall_cube.script = script;
+	wall_cube.next = 0;
+}
+
+void CubeWall::step() {
+	for (WallCube& wall_cube : cubes) {
+		Session& session = wall_cube.session;
+
+		// ONCE THE SCRIPT HAS PLAYED OUT AND THE HOLD IS OVER, THE NEXT ONE STARTS
+		if (wall_cube.next == wall_cube.script.size() && session.idle()) {
+			if (wall_cube.wait > 0) {
+				wall_cube.wait--;
+			} else {
+				next_script(*this, wall_cube);
+			}
+		}
+
+		// ONE MOVE WAITING AT A TIME, MOVES THAT COMMUTE WITH THE RUNNING ONE STILL START RIGHT AWAY
+		if (wall_cube.next < wall_cube.script.size() && session.move_queue.empty()) {
+			session.queue_move(wall_cube.script[wall_cube.next++]);
+			if (wall_cube.next == wall_cube.script.size()) {
+				wall_cube.wait = wall_cube.solving ? WALL_HOLD_STEPS : WALL_HOLD_STEPS / 2;
+			}
+		}
+
+		session.step();
+	}
+}
+
+void CubeWall::render(FrameContext& frame, const glm::mat4& proj, const glm::mat4& view) {
+	drawn.clear();
+	for (const WallCube& wall_cube : cubes) drawn.push_back(&wall_cube.session.cube);
+	render_cubes(drawn, frame, proj, view);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Render.hpp"
+#include "Session.hpp"
+
+// MOST CUBES A WALL HOLDS
+constexpr int WALL_MAX_CUBES = 400;
+
+// ONE CUBE OF THE WALL, ITS SESSION PLAYS script (A SCRAMBLE FOLLOWED BY ITS SOLUTION) ONE MOVE AT A TIME
+struct WallCube {
+	Session session;
+	std::vector<Move> script;
+	size_t next = 0;
+	bool solving = false;
+
+	// STEPS LEFT BEFORE THE NEXT SCRIPT STARTS (STAGGERS THE CUBES AND HOLDS A SOLVED CUBE FOR A MOMENT)
+	int wait = 0;
+};
+
+// MANY CUBES SOLVING AT ONCE, LAID OUT ON A GRID FACING THE CAMERA, ALL DRAWN FROM THE ONE SHARED MESH
+// cubes IS SIZED BY setup
+struct CubeWall {
+	std::vector<WallCube> cubes;
+
+	// SCRAMBLES READ FROM A FILE, USED IN TURN, RANDOM ONES ARE GENERATED WHEN THERE ARE NONE
+	std::vector<std::vector<Move>> scrambles;
+	size_t next_scramble = 0;
+	std::mt19937 random;
+
+	// SOLUTIONS COME FROM THE SOLVER (3x3 WITH ITS TABLES LOADED), OTHERWISE THE SCRAMBLE IS PLAYED BACKWARDS
+	bool use_solver = false;
+	long solves = 0;
+
+	int columns = 0;
+	int rows = 0;
+
+	// PLACES count CUBES, READING ONE SCRAMBLE PER LINE FROM scramble_path WHEN IT IS NOT EMPTY
+	bool setup(int count, const std::string& scramble_path, bool solver, uint32_t seed, std::string& error);
+
+	// LAYS THE CUBES OUT ON A GRID WITH THE SAME PROPORTIONS AS THE VIEW OF proj (NEEDED AGAIN AFTER A RESIZE)
+	void layout(const glm::mat4& proj);
+
+	// CAMERA DISTANCE AT WHICH THE WHOLE GRID FITS THE VIEW OF proj (FROM STRAIGHT AHEAD)
+	float camera_distance(const glm::mat4& proj) const;
+
+	// ONE SIMULATION STEP OF EVERY CUBE, FEEDING EACH THE NEXT MOVE OF ITS SCRIPT
+	void step();
+
+	// CLEARS SCREEN AND ZBUFFER AND DRAWS EVERY CUBE (render_cubes)
+	void render(FrameContext& frame, const glm::mat4& proj, const glm::mat4& view);
+
+	// CUBE LIST HANDED TO render_cubes, KEPT TO AVOID AN ALLOCATION PER FRAME
+	std::vector<const Cube*> drawn;
+};
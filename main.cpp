@@ -1,16 +1,36 @@
 #include <iostream>
 #include <csignal>
-#include <ftxui/screen/screen.hpp>
+#include <ftxui/screen/terminal.hpp>
+#include <cstdio>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include "CubeUnit.hpp"
 #include <termios.h>
 #include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
 #include <chrono>
 #include <thread>
 #include "Transform.hpp"
+#include "Render.hpp"
+#include "Bench.hpp"
+#include "Batch.hpp"
+#include "Snapshot.hpp"
+#include "Output.hpp"
+#include "Pacing.hpp"
+#include "Solver.hpp"
+#include "MoveHistory.hpp"
+#include "Profile.hpp"
+#include "Session.hpp"
+#include "Recording.hpp"
+#include "Wall.hpp"
 #include <string>
+#include <cmath>
+#include <vector>
 #include <random>
+#include <algorithm>
+#include <cstdlib>
 
 // COLLECT USER INPUT
 void set_raw_mode(bool enable) {
@@ -26,664 +46,625 @@ void set_raw_mode(bool enable) {
 	}
 }
 
+// SET BY SIGWINCH, THE FRAME CONTEXT IS ONLY RESIZED WHEN THIS IS RAISED
+volatile std::sig_atomic_t terminal_resized = 1;
+
+// SELF PIPE, SIGNAL HANDLERS WRITE A BYTE SO AN IDLE poll() WAKES UP
+int wake_pipe[2] = {-1, -1};
+
+void handle_resize(int) {
+	terminal_resized = 1;
+	int saved_errno = errno;
+	if (write(wake_pipe[1], "", 1) < 0) {}
+	errno = saved_errno;
+}
+
 // DONT BREAK CURSOR ON EXIT
-void handle_exit(int) {
+void restore_terminal() {
 	std::cout << "\033[?25h" << std::flush;
 	set_raw_mode(false);
 	// EXIT ALTERNATE SCREEN BUFFER
 	std::cout << "\033[?1049l";
 	std::cout.flush();
-	std::exit(0);
 }
 
-// DETECT KEY EVENTS
-char poll_keypress() {
-	struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
-	if (poll(&pfd, 1, 0) > 0) {
-		char c;
-		if (read(STDIN_FILENO, &c, 1) > 0) {
-			return c;
-		}
+// SET BY SIGINT/SIGTERM, THE MAIN LOOP THEN FINISHES THE FRAME AND EXITS (WRITING THE TRACE)
+volatile std::sig_atomic_t quit_requested = 0;
+
+// A SECOND SIGNAL EXITS RIGHT AWAY IN CASE THE LOOP IS STUCK
+void handle_exit(int) {
+	if (quit_requested) {
+		restore_terminal();
+		std::_Exit(0);
 	}
-	return '\0';
+	quit_requested = 1;
+	int saved_errno = errno;
+	if (write(wake_pipe[1], "", 1) < 0) {}
+	errno = saved_errno;
 }
 
-struct Vec2i {
-	int x, y;
-};
-
-// RENDER LINE ON SCREEN WITH ZBUFFER FROM x0 x0 z0 TO x1 y1 z1
-void render_line(
-		int x0, int y0, float z0,
-		int x1, int y1, float z1,
-		ftxui::Screen& screen,
-		ftxui::Color color,
-		std::vector<std::vector<float>>& zbuffer
-		) {
-	bool steep = abs(y1 - y0) > abs(x1 - x0);
-
-	if (steep) {
-		std::swap(x0, y0);
-		std::swap(x1, y1);
-	}
-	if (x0 > x1) {
-		std::swap(x0, x1);
-		std::swap(y0, y1);
-		std::swap(z0, z1);
+// READS EVERY KEY ALREADY WAITING (UP TO size), RETURNS HOW MANY
+int read_keys(char* keys, int size) {
+	int count = 0;
+	struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+	while (count < size && poll(&pfd, 1, 0) > 0) {
+		ssize_t n = read(STDIN_FILENO, keys + count, size - count);
+		if (n <= 0) break;
+		count += (int)n;
 	}
+	return count;
+}
 
-	int dx = x1 - x0;
-	int dy = abs(y1 - y0);
-	float dz = (dx == 0) ? 0.0f : (z1 - z0) / dx;
-	float z = z0;
-
-	int error = dx / 2;
-	int ystep = (y0 < y1) ? 1 : -1;
-	int y = y0;
-
-	for (int x = x0; x <= x1; ++x) {
-		int draw_x = steep ? y : x;
-		int draw_y = steep ? x : y;
-
-		if (draw_x >= 0 && draw_x < screen.dimx() && draw_y >= 0 && draw_y < screen.dimy() && z < zbuffer[draw_y][draw_x]) {
-			zbuffer[draw_y][draw_x] = z;
-			auto& pixel = screen.PixelAt(draw_x, draw_y);
-			pixel.foreground_color = color;
-			pixel.character = U'@';
-		}
+// BLOCKS (WITHOUT BURNING CPU) UNTIL A KEY IS READABLE OR A SIGNAL WROTE TO THE WAKE PIPE
+void wait_for_event() {
+	struct pollfd fds[2] = {
+		{ STDIN_FILENO, POLLIN, 0 },
+		{ wake_pipe[0], POLLIN, 0 },
+	};
+	while (poll(fds, 2, -1) < 0 && errno == EINTR) {}
 
-		z += dz;
-		error -= dy;
-		if (error < 0) {
-			y += ystep;
-			error += dx;
-		}
-	}
+	// DRAIN THE WAKE PIPE, terminal_resized ALREADY RECORDS WHAT HAPPENED
+	char drain[16];
+	while (read(wake_pipe[0], drain, sizeof(drain)) > 0) {}
 }
 
-// SCANLINE TRIANGLE FILL FUNCTION
-void fill_triangle(
-		Vec2i v0, float z0,
-		Vec2i v1, float z1,
-		Vec2i v2, float z2,
-		ftxui::Screen& screen, 
-		ftxui::Color color, 
-		std::vector<std::vector<float>>& zbuffer
-		) {
-	if (v0.y > v1.y) {
-		std::swap(v0, v1);
-		std::swap(z0, z1);
-	}
-	if (v0.y > v2.y) {
-		std::swap(v0, v2);
-		std::swap(z0, z2);
+int main(int argc, char** argv) {
+	// HEADLESS BENCHMARK, BATCH, SNAPSHOT AND MAXIMUM SPEED REPLAY MODES NEVER TOUCH THE TERMINAL
+	bool replay_max = false;
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--bench") return run_bench(argc, argv);
+		if (std::string(argv[i]) == "--batch") return run_batch(argc, argv);
+		if (std::string(argv[i]) == "--snapshot") return run_snapshot(argc, argv);
+		if (std::string(argv[i]) == "--max") replay_max = true;
 	}
-	if (v1.y > v2.y) {
-		std::swap(v1, v2);
-		std::swap(z1, z2);
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--replay" && replay_max) return run_replay(argc, argv);
 	}
 
-	auto draw_scanline = [&](int y, int x_start, float z_start, int x_end, float z_end) {
-		if (x_start > x_end) {
-			std::swap(x_start, x_end);
-			std::swap(z_start, z_end);
+	// RASTER THREADS, DEFAULTS TO THE CORE COUNT (CAPPED, SMALL TERMINALS ONLY HAVE A FEW TILES)
+	int raster_threads = std::min(8, (int)std::max(1u, std::thread::hardware_concurrency()));
+
+	// FRAME RATE CAP, THE PACER DROPS TO HALF OR A QUARTER OF IT WHEN FRAMES TAKE TOO LONG
+	double fps_cap = 60.0;
+
+	// --profile SHOWS THE TIMINGS OVERLAY FROM THE START, --trace FILE WRITES A CHROME TRACE ON EXIT
+	bool display_profile = false;
+	std::string trace_path;
+
+	// TERMINAL ENCODING, PLAIN 16 COLOR ANSI WORKS EVERYWHERE (THE CUBE ONLY USES NAMED COLORS)
+	OutputMode output_mode = OutputMode::Ansi16;
+
+	// --subcell half|quad RASTERIZES 1x2 OR 2x2 SAMPLES PER CELL AND DRAWS THEM AS BLOCK ELEMENTS
+	CellMode cell_mode = CellMode::Full;
+
+	// --record FILE SAVES THE SESSION, --replay FILE PLAYS ONE BACK (AT --speed TIMES REAL TIME) INSTEAD OF TAKING INPUT
+	std::string record_path;
+	std::string replay_path;
+	double replay_speed = 1.0;
+
+	// --wall N SHOWS N CUBES SOLVING AT ONCE (SCRAMBLES FROM --input FILE, ONE PER LINE, OR RANDOM)
+	bool wall_mode = false;
+	int wall_count = 0;
+	std::string scramble_path;
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--threads" && i + 1 < argc) raster_threads = std::atoi(argv[++i]);
+		if (std::string(argv[i]) == "--fps" && i + 1 < argc) fps_cap = std::atof(argv[++i]);
+		if (std::string(argv[i]) == "--profile") display_profile = true;
+		if (std::string(argv[i]) == "--hiz") set_depth_rejection(true);
+		if (std::string(argv[i]) == "--trace" && i + 1 < argc) trace_path = argv[++i];
+		if (std::string(argv[i]) == "--record" && i + 1 < argc) record_path = argv[++i];
+		if (std::string(argv[i]) == "--replay" && i + 1 < argc) replay_path = argv[++i];
+		if (std::string(argv[i]) == "--speed" && i + 1 < argc) replay_speed = std::atof(argv[++i]);
+		if (std::string(argv[i]) == "--wall" && i + 1 < argc) {
+			wall_mode = true;
+			wall_count = std::atoi(argv[++i]);
+		}
+		if (std::string(argv[i]) == "--input" && i + 1 < argc) scramble_path = argv[++i];
+		if (std::string(argv[i]) == "--output" && i + 1 < argc) {
+			const char* name = argv[++i];
+			if (!parse_output_mode(name, output_mode) || output_mode == OutputMode::Ppm) {
+				std::cerr << "unknown --output " << name << " (expected ftxui, ansi16, ansi256 or truecolor)\n";
+				return 1;
+			}
+		}
+		if (std::string(argv[i]) == "--subcell" && i + 1 < argc) {
+			const char* name = argv[++i];
+			if (!parse_cell_mode(name, cell_mode)) {
+				std::cerr << "unknown --subcell " << name << " (expected full, half or quad)\n";
+				return 1;
+			}
 		}
-		render_line(x_start, y, z_start, x_end, y, z_end, screen, color, zbuffer);
-	};
-
-	auto interpolate = [](int y0, int x0, int y1, int x1, int y) -> int {
-		if (y1 == y0) return x0;
-		return x0 + (x1 - x0) * (y - y0) / (y1 - y0);
-	};
-
-	auto interpolate_z = [](int y0, float z0, int y1, float z1, int y) -> float {
-		if (y1 == y0) return z0;
-		return z0 + (z1 - z0) * (y - y0) / (y1 - y0);
-	};
-
-	for (int y = v0.y; y <= v1.y; ++y) {
-		int xa = interpolate(v0.y, v0.x, v2.y, v2.x, y);
-		int xb = interpolate(v0.y, v0.x, v1.y, v1.x, y);
-		float za = interpolate_z(v0.y, z0, v2.y, z2, y);
-		float zb = interpolate_z(v0.y, z0, v1.y, z1, y);
-		draw_scanline(y, xa, za, xb, zb);
 	}
-
-	for (int y = v1.y; y <= v2.y; ++y) {
-		int xa = interpolate(v0.y, v0.x, v2.y, v2.x, y);
-		int xb = interpolate(v1.y, v1.x, v2.y, v2.x, y);
-		float za = interpolate_z(v0.y, z0, v2.y, z2, y);
-		float zb = interpolate_z(v1.y, z1, v2.y, z2, y);
-		draw_scanline(y, xa, za, xb, zb);
+	if (!(fps_cap > 0.0)) {
+		std::cerr << "--fps must be positive\n";
+		return 1;
 	}
-}
-
-// PROJECTS TRIANGLE VECTORS AND SENDS TO TRIANGLE SCANLINE FILL
-void render_triangle(Triangle& triangle, ftxui::Screen& screen, glm::mat4 proj, glm::mat4 view, std::vector<std::vector<float>>& zbuffer) {
-	glm::vec3 p0_view = glm::vec3(view * glm::vec4(triangle.points[0], 1.0f));
-	glm::vec3 p1_view = glm::vec3(view * glm::vec4(triangle.points[1], 1.0f));
-	glm::vec3 p2_view = glm::vec3(view * glm::vec4(triangle.points[2], 1.0f));
-
-	glm::vec3 edge1 = p1_view - p0_view;
-	glm::vec3 edge2 = p2_view - p0_view;
-	glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
-	
-	float dot = glm::dot(normal, p0_view);
-
-	if (dot <= 0) {
-		return;
+	if (!(replay_speed > 0.0)) {
+		std::cerr << "--speed must be positive\n";
+		return 1;
 	}
-
-	glm::vec4 v0 = proj * view * glm::vec4(triangle.points[0], 1.0f);
-	glm::vec4 v1 = proj * view * glm::vec4(triangle.points[1], 1.0f);
-	glm::vec4 v2 = proj * view * glm::vec4(triangle.points[2], 1.0f);
-
-	int width = screen.dimx();
-	int height = screen.dimy();
-
-	v0 /= v0.w;
-	v1 /= v1.w;
-	v2 /= v2.w;
-
-	int x0 = (int)((v0.x + 1.0f) * 0.5f * width);
-	int y0 = (int)((1.0f - v0.y) * 0.5f * height);
-	int x1 = (int)((v1.x + 1.0f) * 0.5f * width);
-	int y1 = (int)((1.0f - v1.y) * 0.5f * height);
-	int x2 = (int)((v2.x + 1.0f) * 0.5f * width);
-	int y2 = (int)((1.0f - v2.y) * 0.5f * height);
-	Vec2i vi0 = { x0, y0 };
-	Vec2i vi1 = { x1, y1 };
-	Vec2i vi2 = { x2, y2 };
-	fill_triangle(vi0, v0.z, vi1, v1.z, vi2, v2.z, screen, triangle.color, zbuffer);
-}
-
-// CONSTRUCTS PLANE FROM NORMAL
-Plane MakePlane(glm::vec3 normal, ftxui::Color color, bool invert_normal) {
-	glm::vec3 p0 = {-0.5f, -0.5f, 0.0f};
-	glm::vec3 p1 = { 0.5f, -0.5f, 0.0f};
-	glm::vec3 p2 = { 0.5f,  0.5f, 0.0f};
-	glm::vec3 p3 = {-0.5f,  0.5f, 0.0f};
-
-	Triangle tri1 = {{p0, p1, p2}, color};
-	if (invert_normal)
-		tri1 = {{p2, p1, p0}, color};
-	Triangle tri2 = {{p2, p3, p0}, color};
-	if (invert_normal)
-		tri2 = {{p0, p3, p2}, color};
-
-	glm::vec3 axis = glm::cross(glm::vec3(0, 0, 1), normal);
-	float angle = acos(glm::dot(glm::normalize(normal), glm::vec3(0, 0, 1)));
-
-	glm::mat4 rotation = glm::mat4(1.0f);
-	if (glm::length(axis) > 0.001f)
-		rotation = glm::rotate(glm::mat4(1.0f), angle, glm::normalize(axis));
-
-	return Plane{tri1, tri2, normal * 0.5f, rotation};
-}
-
-// CONSTRUCTS UNIT OF RUBIKS CUBE (27 TOTAL)
-CubeUnit MakeCubeUnit(glm::vec3 position) {
-	float padding = 0.2f;
-	std::array<Plane, 6> faces = {
-		MakePlane({ 0,  0,  1 + padding}, position.z < 1.0f ? ftxui::Color::Black : ftxui::Color::Red, true),    // Front
-		MakePlane({ 0,  0, -1 - padding}, position.z > -1.0f ? ftxui::Color::Black : ftxui::Color::RedLight, false), // Back
-		MakePlane({-1 - padding,  0,  0}, position.x > -1.0f ? ftxui::Color::Black : ftxui::Color::Blue, true),   // Left
-		MakePlane({ 1 + padding,  0,  0}, position.x < 1.0f ? ftxui::Color::Black : ftxui::Color::Green, true),  // Right
-		MakePlane({ 0,  1 + padding,  0}, position.y < 1.0f ? ftxui::Color::Black : ftxui::Color::YellowLight, true),  // Top
-		MakePlane({ 0, -1 - padding,  0}, position.y > -1.0f ? ftxui::Color::Black : ftxui::Color::White, true), // Bottom
-	};
-
-	CubeUnit unit;
-	for (int i = 0; i < 6; i++) {
-		unit.plane[i] = faces[i];
+	if (!record_path.empty() && !replay_path.empty()) {
+		std::cerr << "--record and --replay cannot be combined\n";
+		return 1;
 	}
-	unit.position = position;
-	unit.rotation = glm::mat4(1.0f); // identity rotation
-	return unit;
-}
-
-// APPLIES PLANAR TRANSFORMATIONS AND SENDS TO TRIANGLE RENDERING PIPELINE
-void render_plane(const Plane& plane, ftxui::Screen& screen, const glm::mat4& proj, const glm::mat4& view, std::vector<std::vector<float>>& zbuffer) {
-	glm::mat4 model = glm::translate(glm::mat4(1.0f), plane.position) * plane.rotation;
-
-	for (const Triangle& tri : {plane.tri1, plane.tri2}) {
-		Triangle transformed = tri;
-		for (int i = 0; i < 3; i++) {
-			glm::vec4 world = model * glm::vec4(tri.points[i], 1.0f);
-			transformed.points[i] = glm::vec3(world);
+	if (wall_mode && (!record_path.empty() || !replay_path.empty())) {
+		std::cerr << "--wall cannot be combined with --record or --replay\n";
+		return 1;
+	}
+	CubeWall wall;
+	if (wall_mode) {
+		std::string error;
+		if (!wall.setup(wall_count, scramble_path, true, std::random_device{}(), error)) {
+			std::cerr << error << "\n";
+			return 1;
 		}
-		render_triangle(transformed, screen, proj, view, zbuffer);
 	}
-}
-
-// APPLIES CUBEUNIT TRANSFORMATIONS AND SENDS TO PLANE RENDERING PIPELINE
-void render_cubeunit(CubeUnit cubeunit, ftxui::Screen& screen, glm::mat4 proj, glm::mat4 view, std::vector<std::vector<float>>& zbuffer) {
-	for (int i = 0; i < 6; i++) {
-		const Plane& plane = cubeunit.plane[i];
-
-		Plane transformed_plane = plane;
-		transformed_plane.position = glm::vec3(cubeunit.rotation * glm::vec4(plane.position, 1.0f));
-		transformed_plane.rotation = cubeunit.rotation * plane.rotation;
-		transformed_plane.position += cubeunit.position;
-
-		render_plane(transformed_plane, screen, proj, view, zbuffer);
+	SessionRecorder recorder;
+	if (!record_path.empty() && !recorder.open(record_path)) {
+		std::cerr << "could not open " << record_path << " for recording\n";
+		return 1;
 	}
-}
-
-// BUILDS CUBE (3x3x3)
-Cube MakeCube() {
-	float padding = 0.4f;
-	Cube cube;
-	for (int i = 0; i < 27; i++) {
-		int x = i%3 - 1;
-		int y = i/3%3 - 1;
-		int z = i/9 - 1;
-		CubeUnit cube_unit = MakeCubeUnit(glm::vec3((padding + 1.0f) * (float)x, (padding + 1.0f) * (float)y, (padding + 1.0f) * (float)z));
-		cube.units[i] = cube_unit;
+	SessionReader replay;
+	bool replaying = !replay_path.empty();
+	if (replaying) {
+		std::string error;
+		if (!replay.open(replay_path, error)) {
+			std::cerr << error << "\n";
+			return 1;
+		}
 	}
-	return cube;
-}
 
-int main() {
 	// ENTER ALTERNATE SCREEN BUFFER
 	std::cout << "\033[?1049h";
 
 
 	// SETUP TERMINAL FOR VISUAL MODE AND GET USER INPUT
 	set_raw_mode(true);
+	if (pipe(wake_pipe) == 0) {
+		fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+		fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+	}
 	static auto start_time = std::chrono::high_resolution_clock::now();
 	std::signal(SIGINT, handle_exit);
 	std::signal(SIGTERM, handle_exit);
+	std::signal(SIGWINCH, handle_resize);
 
 	// INITIALIZE CLOCK (USEFUL FOR FPS AND DELTATIME TRANSITIONS)
 	using Clock = std::chrono::high_resolution_clock;
 	auto last_time = Clock::now();
 	int fps = 0;
-	const double target_framerate = 60.0;
-	const auto target_frame_duration = std::chrono::duration<double>(1.0 / target_framerate);
+	FramePacer pacer;
+	pacer.cap = fps_cap;
+
+	// WALL CLOCK TIME NOT YET CONSUMED BY FIXED SIMULATION STEPS
+	double sim_accumulator = 0.0;
+
+	// INITIALIZE CUBE, CAMERA, TURN ANIMATIONS, MOVE LIST AND MOVE QUEUE
+	Session session;
+
+	// NEXT RECORDED EVENT OF A REPLAY, APPLIED ONCE THE SIMULATION REACHES ITS TICK
+	SessionEvent replay_event;
+	bool replay_pending = replaying && replay.next(replay_event);
+	char replay_text[48] = "";
+	char wall_text[48] = "";
+
+	// EVERY INPUT GOES THROUGH HERE SO A RECORDING HOLDS EXACTLY WHAT THE SIMULATION SAW
+	auto input = [&](SessionEvent& event) {
+		event.tick = session.ticks;
+		apply_event(session, event);
+		recorder.write(event);
+	};
 
-	// INITIALIZE CUBE
-	Cube cube = MakeCube();
+	// LAYER THE NEXT FACE KEY TURNS (0 = OUTER), PICKED WITH THE DIGIT KEYS
+	int layer = 0;
 
-	// INITIALIZE CAMERA CONTROLS
-	float pitch = 0.0f;
-	float yaw = 0.0f;
-	float pitch_vel = 0.0f;
-	float yaw_vel = 0.0f;
+	// SCREEN AND ZBUFFER PERSIST ACROSS FRAMES
+	FrameContext frame;
+	frame.cell_mode = cell_mode;
+	frame.tiles.set_threads(raster_threads);
 
-	// INITIALIZE TRANSFORM AND MOVE LIST
-	Transform current_transform;
-	current_transform.progress = 1.0f;
-	std::vector<char> move_list = {};
+	// FRAMES ARE ENCODED AND WRITTEN ON THEIR OWN THREAD, A BACKED UP TERMINAL ONLY DROPS FRAMES
+	std::cout.flush();
+	FrameWriter writer(STDOUT_FILENO, make_encoder(output_mode));
+
+	// FPS TEXT IS ONLY REFORMATTED WHEN THE VALUE CHANGES
+	char fps_text[16] = "FPS: 0";
+	int fps_shown = 0;
 
 	// SHOW HELP BY DEFAULT
 	bool display_help = true;
 
-	// MAIN LOOP
-	while (true) {
-		// INITIALIZE SCREEN
-		auto screen = ftxui::Screen::Create(
-				ftxui::Dimension::Full(),
-				ftxui::Dimension::Full()
-				);
+	// STAGE TIMINGS ARE ONLY COLLECTED WHILE THE OVERLAY IS SHOWN OR A TRACE IS BEING RECORDED
+	profiler.enabled = display_profile;
+	profiler.tracing = !trace_path.empty();
+	if (profiler.tracing) profiler.events.reserve(TRACE_EVENT_LIMIT / 16);
 
-		int width = screen.dimx();
-		int height = screen.dimy();
-		double aspect = width / (double)height / 2.0;
+	// OVERLAY TEXT IS REFORMATTED A FEW TIMES PER SECOND SO THE NUMBERS STAY READABLE
+	char profile_text[STAGE_COUNT + 3][40] = {};
+	auto profile_shown = Clock::now() - std::chrono::seconds(1);
 
-		// INITIALIZE ZBUFFER TO INFINITY
-		std::vector<std::vector<float>> zbuffer(height, std::vector<float>(width, INFINITY));
+	// NOTHING MOVES WHILE idle, THE LOOP THEN SLEEPS IN poll() UNTIL A KEY OR RESIZE ARRIVES
+	bool idle = false;
+	uint64_t last_scene_hash = 0;
+	uint64_t last_overlay_hash = 0;
 
-		char key = poll_keypress();
+	// THE LAST RENDERED SCENE WITHOUT OVERLAYS, A FRAME WHERE ONLY OVERLAY TEXT CHANGED STARTS FROM IT
+	Framebuffer scene_frame;
 
-		// CAMERA CONTROLS
-		if (key == 'd') yaw_vel += 0.05;
-		if (key == 'a') yaw_vel -= 0.05;
-		if (key == 'w') pitch_vel += 0.05;
-		if (key == 's') pitch_vel -= 0.05;
+	// MAIN LOOP
+	while (!quit_requested) {
+		if (idle && !terminal_resized) {
+			wait_for_event();
+			last_time = Clock::now();
+			sim_accumulator = 0.0;
+			if (quit_requested) break;
+		}
+		auto frame_start = Clock::now();
+		ScopedTimer frame_timer(STAGE_FRAME);
+		ScopedTimer input_timer(STAGE_INPUT);
+
+		// RESIZE SCREEN AND ZBUFFER ONLY WHEN THE TERMINAL CHANGED SIZE
+		if (terminal_resized) {
+			terminal_resized = 0;
+			ftxui::Dimensions size = ftxui::Terminal::Size();
+			if (frame.resize(size.dimx, size.dimy)) {
+				SessionEvent event;
+				event.tick = session.ticks;
+				event.type = EVENT_RESIZE;
+				event.width = size.dimx;
+				event.height = size.dimy;
+				event.cell_mode = cell_mode;
+				event.depth_rejection = depth_rejection();
+				recorder.write(event);
+			}
+		}
 
-		// TOGGLE HELP
-		if (key == 'h') display_help = !display_help;
+		Framebuffer& screen = frame.screen;
+		int width = screen.width;
+		int height = screen.height;
 
-		// CONTROL MAPPING
-		char move = '\0';
+		// EVERY KEY THAT ARRIVED SINCE THE LAST FRAME IS HANDLED IN ORDER, TURNS GO TO THE MOVE QUEUE
+		char keys[64];
+		int key_count = read_keys(keys, sizeof(keys));
+		for (int k = 0; k < key_count; k++) {
+			char key = keys[k];
 
-		if (key == 'i') move = 'u';
-		if (key == 'o') move = 'U';
+			// TOGGLE HELP
+			if (key == 'h') display_help = !display_help;
 
-		if (key == 'p') move = 'r';
-		if (key == ';') move = 'R';
+			// TOGGLE TIMINGS OVERLAY
+			if (key == 't') {
+				display_profile = !display_profile;
+				profiler.enabled = display_profile;
+			}
 
-		if (key == 'u') move = 'L';
-		if (key == 'j') move = 'l';
+			// A REPLAY ONLY TAKES THE DISPLAY TOGGLES, EVERYTHING ELSE COMES FROM THE RECORDING
+			if (replaying) continue;
+
+			// CAMERA CONTROLS
+			int yaw_steps = (key == 'd') - (key == 'a');
+			int pitch_steps = (key == 'w') - (key == 's');
+			if (yaw_steps != 0 || pitch_steps != 0) {
+				SessionEvent event;
+				event.type = EVENT_CAMERA;
+				event.yaw_steps = yaw_steps;
+				event.pitch_steps = pitch_steps;
+				input(event);
+			}
 
-		if (key == 'k') move = 'F';
-		if (key == 'l') move = 'f';
+			// THE WALL PLAYS ITS OWN SCRIPTS, ONLY THE CAMERA IS STEERED
+			if (wall_mode) continue;
 
-		if (key == ',') move = 'b';
-		if (key == '.') move = 'B';
+			// CONTROL MAPPING (MOVE LIST LETTERS)
+			char letter = '\0';
 
-		if (key == 'm') move = 'D';
-		if (key == '/') move = 'd';
+			if (key == 'i') letter = 'u';
+			if (key == 'o') letter = 'U';
 
-		// TRANSFORM MOVE MAPPING
-		if (key == 'q') move = 'y';
-		if (key == 'e') move = 'Y';
+			if (key == 'p') letter = 'r';
+			if (key == ';') letter = 'R';
 
-		if (key == 'r') move = 'x';
-		if (key == 'f') move = 'X';
+			if (key == 'u') letter = 'L';
+			if (key == 'j') letter = 'l';
 
-		if (key == 'x') move = 'Z';
-		if (key == 'c') move = 'z';
+			if (key == 'k') letter = 'F';
+			if (key == 'l') letter = 'f';
 
-		// SPACE = RANDOM MOVE
-		if (key == ' ') {
-			std::string moves = "udrlfbUDRLFB";
-			std::random_device rd;
-			std::mt19937 gen(rd());
-			std::uniform_int_distribution<> dis(0, moves.size() - 1);
-			
-			move = moves[dis(gen)];
-		}
+			if (key == ',') letter = 'b';
+			if (key == '.') letter = 'B';
 
-		// Z = UNDO LAST MOVE (DO INVERSE OF LAST MOVE)
-		if (key == 'z') {
-			if (move_list.size() > 0) {
-				char last_move = move_list.back();
-				move = islower(last_move) ? toupper(last_move) : tolower(last_move);
-			}
-		}
+			if (key == 'm') letter = 'D';
+			if (key == '/') letter = 'd';
 
-		// STARTING A NEW CUBE MOVE CANCELS PREVIOUS ANIMATIONS
-		bool starting_move = false;
-		bool cancel_transform = false;
-		if (tolower(move) == 'u') starting_move = true;
-		if (tolower(move) == 'd') starting_move = true;
-		if (tolower(move) == 'r') starting_move = true;
-		if (tolower(move) == 'l') starting_move = true;
-		if (tolower(move) == 'f') starting_move = true;
-		if (tolower(move) == 'b') starting_move = true;
-		if (tolower(move) == 'x') starting_move = true;
-		if (tolower(move) == 'y') starting_move = true;
-		if (tolower(move) == 'z') starting_move = true;
-
-		if (starting_move) cancel_transform = true;
-
-		// CLAMP PRECISION TO AVOID ARTIFACTS
-		if (current_transform.progress > 0.99) cancel_transform = true;
-		if (std::abs(yaw_vel) < 0.001) yaw_vel = 0.0f;
-		if (std::abs(pitch_vel) < 0.001) pitch_vel = 0.0f;
-
-		// CALCULATE TRANSFORM PROGRESS
-		double temp = current_transform.progress;
-		current_transform.progress = current_transform.progress * 0.9 + 0.1;
-		double delta_trans = current_transform.progress - temp;
-
-		// CANCELING TRANSFORM SETS DELTA TRANSFORM TO THE REMAINING TRANSFORM
-		if (cancel_transform) {
-			delta_trans += 1.0 - current_transform.progress;
-			current_transform.progress = 1.0f;
-		}
+			// TRANSFORM MOVE MAPPING
+			if (key == 'q') letter = 'y';
+			if (key == 'e') letter = 'Y';
 
-		// APPLY TRANSFORM
-		for ( auto& ref : current_transform.affected ) {
-			CubeUnit& cube_unit = ref.get();
+			if (key == 'r') letter = 'x';
+			if (key == 'f') letter = 'X';
 
-			glm::mat4 rot = glm::rotate(glm::mat4(1.0f), (float)(current_transform.direction * delta_trans * glm::half_pi<float>()), current_transform.axis);
-			cube_unit.position = glm::vec3(rot * glm::vec4(cube_unit.position, 1.0f));
-			cube_unit.rotation = rot * cube_unit.rotation;
-		}
+			if (key == 'x') letter = 'Z';
+			if (key == 'c') letter = 'z';
 
-		// IF STARTING MOVE RESET TRANSFORM
-		if (starting_move) {
-			current_transform.affected = {};
-			current_transform.progress = 0.0f;
-			current_transform.direction = tolower(move) == move ? 1.0f : -1.0f;
-		}
+			// DIGITS PICK THE LAYER THE NEXT FACE KEY TURNS (1 = OUTER LAYER)
+			if (key >= '1' && key <= '9' && key - '1' < TURN_DEPTHS) layer = key - '1';
 
-		// KEY EVENTS
-		if (tolower(move) == 'u') {
-			current_transform.axis = glm::vec3(0, -1, 0);
-			for (int i = 0; i < 27; i++) {
-				CubeUnit& cube_unit = cube.units[i];
-				if (cube_unit.position.y >= 1.0) {
-					current_transform.affected.push_back(std::ref(cube_unit));
-				}
+			Move move;
+			bool queue_move = false;
+			if (letter != '\0') {
+				std::string token;
+				if (layer > 0 && move_from_char(letter) < MOVE_X) token += (char)('1' + layer);
+				token += letter;
+				size_t at = 0;
+				queue_move = read_move(token, at, move);
+				layer = 0;
 			}
-		}
-		if (tolower(move) == 'd') {
-			current_transform.axis = glm::vec3(0, 1, 0);
-			for (int i = 0; i < 27; i++) {
-				CubeUnit& cube_unit = cube.units[i];
-				if (cube_unit.position.y <= -1.0) {
-					current_transform.affected.push_back(std::ref(cube_unit));
-				}
+
+			// SPACE = RANDOM MOVE (OF ANY LAYER)
+			if (key == ' ') {
+				static std::mt19937 gen(std::random_device{}());
+				std::uniform_int_distribution<> face(0, 5);
+				std::uniform_int_distribution<> depth(0, TURN_DEPTHS - 1);
+				std::uniform_int_distribution<> clockwise(0, 1);
+
+				move = {(uint8_t)face(gen), (int8_t)depth(gen), (uint8_t)(clockwise(gen) ? 1 : 3)};
+				queue_move = true;
 			}
-		}
-		if (tolower(move) == 'r') {
-			current_transform.axis = glm::vec3(-1, 0, 0);
-			for (int i = 0; i < 27; i++) {
-				CubeUnit& cube_unit = cube.units[i];
-				if (cube_unit.position.x >= 1.0) {
-					current_transform.affected.push_back(std::ref(cube_unit));
-				}
+
+			// Z = UNDO LAST MOVE (INVERSE OF THE LAST MOVE OF THE HISTORY FOLLOWED BY THE QUEUED TYPED MOVES)
+			if (key == 'z' && session.undo_move(move)) queue_move = true;
+
+			// A MANUAL MOVE ABANDONS A QUEUED SOLUTION
+			if (queue_move) {
+				SessionEvent event;
+				event.type = EVENT_MOVE;
+				event.move = move;
+				input(event);
 			}
-		}
-		if (tolower(move) == 'l') {
-			current_transform.axis = glm::vec3(1, 0, 0);
-			for (int i = 0; i < 27; i++) {
-				CubeUnit& cube_unit = cube.units[i];
-				if (cube_unit.position.x <= -1.0) {
-					current_transform.affected.push_back(std::ref(cube_unit));
+
+			// V = SOLVE (3x3 ONLY) THE STATE THE QUEUED MOVES LEAD TO, TABLES ARE MAPPED FROM THE CACHE
+			// (OR GENERATED ONCE) ON FIRST USE
+			if (key == 'v') {
+				SessionEvent event;
+				event.type = EVENT_SOLVE;
+				CubeState solver_state;
+				if (to_cube_state(session.planned_state(), solver_state) && load_solver_tables(default_solver_cache_path())) {
+					for (int m : solve(solver_state)) event.moves.push_back(move_from_index(m));
 				}
+				input(event);
 			}
 		}
-		if (tolower(move) == 'f') {
-			current_transform.axis = glm::vec3(0, 0, -1);
-			for (int i = 0; i < 27; i++) {
-				CubeUnit& cube_unit = cube.units[i];
-				if (cube_unit.position.z >= 1.0) {
-					current_transform.affected.push_back(std::ref(cube_unit));
-				}
+
+		input_timer.stop();
+		ScopedTimer transform_timer(STAGE_TRANSFORM);
+
+		// FIXED TIMESTEP SIMULATION, AS MANY STEPS AS THE ELAPSED WALL CLOCK TIME COVERS (TIMES THE REPLAY SPEED)
+		auto sim_now = Clock::now();
+		sim_accumulator += std::chrono::duration<double>(sim_now - last_time).count() * replay_speed;
+		last_time = sim_now;
+		int max_sim_steps = MAX_SIM_STEPS * (int)std::ceil(replay_speed);
+		int sim_steps = 0;
+		while (sim_accumulator >= SIM_STEP && sim_steps < max_sim_steps) {
+			sim_accumulator -= SIM_STEP;
+			sim_steps++;
+
+			// RECORDED INPUT LANDS ON THE TICK IT WAS GIVEN ON
+			while (replay_pending && replay_event.tick <= session.ticks) {
+				apply_event(session, replay_event);
+				replay_pending = replay.next(replay_event);
 			}
+
+			session.step();
+			if (wall_mode) wall.step();
 		}
-		if (tolower(move) == 'b') {
-			current_transform.axis = glm::vec3(0, 0, 1);
-			for (int i = 0; i < 27; i++) {
-				CubeUnit& cube_unit = cube.units[i];
-				if (cube_unit.position.z <= -1.0) {
-					current_transform.affected.push_back(std::ref(cube_unit));
-				}
-			}
+		if (sim_steps == max_sim_steps) sim_accumulator = 0.0;
+		transform_timer.stop();
+
+		// IDLE ONCE NO TURN (OR QUEUED SOLUTION MOVE), CAMERA VELOCITY OR CLAMP IS STILL MOVING THE SCENE
+		// (AND NO RECORDED EVENT IS STILL TO COME, A WALL NEVER RESTS)
+		idle = session.idle() && !replay_pending && !wall_mode;
+
+		// OVERLAY TEXT, ONLY REFORMATTED WHEN ITS NUMBERS CHANGED
+		if (fps != fps_shown) {
+			std::snprintf(fps_text, sizeof(fps_text), "FPS: %d", fps);
+			fps_shown = fps;
 		}
-		if (tolower(move) == 'x') {
-			current_transform.axis = glm::vec3(-1, 0, 0);
-			for (int i = 0; i < 27; i++) {
-				CubeUnit& cube_unit = cube.units[i];
-				current_transform.affected.push_back(std::ref(cube_unit));
+		if (display_profile && Clock::now() - profile_shown > std::chrono::milliseconds(250)) {
+			std::snprintf(profile_text[0], sizeof(profile_text[0]), " stage        min    avg    p99 ms");
+			for (int stage = 0; stage < STAGE_COUNT; stage++) {
+				StageSummary s = profiler.summary((ProfileStage)stage);
+				std::snprintf(profile_text[stage + 1], sizeof(profile_text[stage + 1]), " %-9s %6.2f %6.2f %6.2f",
+					stage_name((ProfileStage)stage), s.min_ms, s.avg_ms, s.p99_ms);
 			}
-		}
-		if (tolower(move) == 'y') {
-			current_transform.axis = glm::vec3(0, -1, 0);
-			for (int i = 0; i < 27; i++) {
-				CubeUnit& cube_unit = cube.units[i];
-				current_transform.affected.push_back(std::ref(cube_unit));
+			std::snprintf(profile_text[STAGE_COUNT + 1], sizeof(profile_text[STAGE_COUNT + 1]), " dropped   %llu",
+				(unsigned long long)writer.dropped());
+
+			// CELLS WRITTEN PER CELL COVERED AND TRIANGLES THE COARSE DEPTH TEST DROPPED, OF THE LAST FRAME DRAWN
+			const RasterCounts& counts = frame.counts;
+			long covered = frame.zbuffer.covered();
+			double overdraw = covered > 0 ? (double)counts.cells / covered : 0.0;
+			if (depth_rejection()) {
+				std::snprintf(profile_text[STAGE_COUNT + 2], sizeof(profile_text[STAGE_COUNT + 2]), " overdraw %5.2f  hi-z %ld/%ld",
+					overdraw, counts.rejected, counts.triangles);
+			} else {
+				std::snprintf(profile_text[STAGE_COUNT + 2], sizeof(profile_text[STAGE_COUNT + 2]), " overdraw %5.2f  hi-z off", overdraw);
 			}
+			profile_shown = Clock::now();
 		}
-		if (tolower(move) == 'z') {
-			current_transform.axis = glm::vec3(0, 0, -1);
-			for (int i = 0; i < 27; i++) {
-				CubeUnit& cube_unit = cube.units[i];
-				current_transform.affected.push_back(std::ref(cube_unit));
+		if (replaying) {
+			if (replay_pending) {
+				std::snprintf(replay_text, sizeof(replay_text), "REPLAY %gx %.1f s", replay_speed, session.ticks * SIM_STEP);
+			} else {
+				std::snprintf(replay_text, sizeof(replay_text), "REPLAY FINISHED");
 			}
 		}
+		if (wall_mode) {
+			std::snprintf(wall_text, sizeof(wall_text), "WALL %d CUBES %ld SOLVED", (int)wall.cubes.size(), wall.solves);
+		}
+		// SCENE STATE THAT DETERMINES THE RENDERED CUBE, IT IS ONLY RENDERED AGAIN WHEN THIS CHANGED
+		uint64_t scene_hash = 14695981039346656037ull;
+		scene_hash = hash_bytes(scene_hash, &session.pitch, sizeof(session.pitch));
+		scene_hash = hash_bytes(scene_hash, &session.yaw, sizeof(session.yaw));
+		scene_hash = hash_bytes(scene_hash, &width, sizeof(width));
+		scene_hash = hash_bytes(scene_hash, &height, sizeof(height));
+		scene_hash = hash_bytes(scene_hash, &session.cube_state, sizeof(session.cube_state));
+		for (const CubeUnit& cube_unit : session.cube.units) {
+			scene_hash = hash_bytes(scene_hash, &cube_unit.position, sizeof(cube_unit.position));
+			scene_hash = hash_bytes(scene_hash, &cube_unit.rotation, sizeof(cube_unit.rotation));
+		}
+		// THE WALL IS ALWAYS TURNING SOMEWHERE, EVERY STEP IS A NEW SCENE (HASHING ITS UNITS WOULD COST MORE THAN IT SAVES)
+		if (wall_mode) scene_hash = hash_bytes(scene_hash, &session.ticks, sizeof(session.ticks));
+		bool scene_changed = scene_hash != last_scene_hash;
+		last_scene_hash = scene_hash;
+
+		// OVERLAYS THAT ARE SHOWN AND THEIR TEXT (HIDDEN ONES DO NOT COUNT), A CHANGE HERE ONLY REPRINTS THEM OVER THE
+		// LAST RENDERED SCENE, SO A CHANGING FPS NUMBER NEVER COSTS A RENDER
+		uint64_t overlay_hash = 14695981039346656037ull;
+		overlay_hash = hash_bytes(overlay_hash, fps_text, sizeof(fps_text));
+		overlay_hash = hash_bytes(overlay_hash, replay_text, sizeof(replay_text));
+		overlay_hash = hash_bytes(overlay_hash, wall_text, sizeof(wall_text));
+		overlay_hash = hash_bytes(overlay_hash, session.move_list.letters.data(), session.move_list.letters.size());
+		overlay_hash = hash_bytes(overlay_hash, &layer, sizeof(layer));
+		overlay_hash = hash_bytes(overlay_hash, &display_help, sizeof(display_help));
+		overlay_hash = hash_bytes(overlay_hash, &display_profile, sizeof(display_profile));
+		if (display_profile) overlay_hash = hash_bytes(overlay_hash, profile_text, sizeof(profile_text));
+		bool overlay_changed = overlay_hash != last_overlay_hash;
+		last_overlay_hash = overlay_hash;
+
+		if (scene_changed) {
+			// SET VIEW AND PROJECTION
+			glm::mat4 proj = camera_projection(width, height);
+
+			// CLEAR SCREEN AND ZBUFFER, RENDER CUBE UNITS (OF EVERY CUBE OF THE WALL, LAID OUT AGAIN TO FOLLOW A RESIZE)
+			if (wall_mode) {
+				wall.layout(proj);
+				wall.render(frame, proj, camera_view(session.pitch, session.yaw, wall.camera_distance(proj)));
+			} else {
+				render_cube(session.cube, frame, proj, camera_view(session.pitch, session.yaw));
+			}
 
-		// IF NEW TRANSFORM STARTED ADD CURRENT KEY TO MOVES
-		if (current_transform.progress == 0.0f) {
-			move_list.push_back(move);
-		}
-
-		// CHECK FOR CANCELING MOVES
-		if (move_list.size() >= 2) {
-			int li = move_list.size() - 1;
-			int sli = li - 1;
-			if (move_list[li] != move_list[sli] && tolower(move_list[li]) == tolower(move_list[sli])) {
-				move_list.pop_back();
-				move_list.pop_back();
+			// A RECORDING KEEPS THE HASH OF EVERY FRAME (WITHOUT OVERLAYS) SO A REPLAY CAN BE CHECKED AGAINST IT
+			if (recorder.out.is_open()) {
+				SessionEvent event;
+				event.tick = session.ticks;
+				event.type = EVENT_FRAME;
+				event.hash = frame_hash(screen);
+				recorder.write(event);
+			}
+			scene_frame = screen;
+		} else if (overlay_changed) {
+			std::copy(scene_frame.cells.begin(), scene_frame.cells.end(), screen.cells.begin());
+		}
+
+		if (scene_changed || overlay_changed) {
+			// DISPLAY FPS
+			screen.print(2, 1, fps_text, COLOR_WHITE, true);
+			screen.print(2, 2, replay_text, COLOR_WHITE, true);
+			screen.print(2, 2, wall_text, COLOR_WHITE, true);
+
+			// DISPLAY MOVE LIST, FOLLOWED BY THE LAYER DIGIT WHILE ONE IS PICKED
+			// ONLY THE LAST width - 4 LETTERS FIT, PRINTED STRAIGHT FROM THE HISTORY (NO COPY PER FRAME)
+			const std::string& moves_shown = session.move_list.letters;
+			size_t moves_fit = (size_t)std::max(0, width - 4);
+			size_t layer_shown = layer > 0 && moves_fit > 0 ? 1 : 0;
+			size_t moves_hidden = moves_shown.size() + layer_shown > moves_fit ? moves_shown.size() + layer_shown - moves_fit : 0;
+			screen.print(2, height-2, moves_shown.c_str() + moves_hidden, COLOR_WHITE, true);
+			if (layer_shown) {
+				char layer_text[2] = {(char)('1' + layer), 0};
+				screen.print(2 + (int)(moves_shown.size() - moves_hidden), height-2, layer_text, COLOR_WHITE, true);
 			}
-		}
 
-		// CHECK FOR TRIPLE MOVES
-		if (move_list.size() >= 3) { 
-			int li = move_list.size() - 1;
-			if (move_list[li] == move_list[li-1] && move_list[li-1] == move_list[li-2]) {
-				// ANY TRIPLE MOVE CAN BE REDUCED TO ITS OPPOSITE; EX yyy => Y, YYY => y
-				char op = move_list[li];
-				if (tolower(op) == move_list[li]) {
-					op = toupper(move_list[li]);
-				} else {
-					op = tolower(move_list[li]);
+			// DISPLAY STAGE TIMINGS (ROLLING OVER THE LAST PROFILE_WINDOW SAMPLES OF EACH STAGE)
+			if (display_profile) {
+				for (int row = 0; row < STAGE_COUNT + 3 && row + 3 < height - 2; row++) {
+					screen.print(1, row + 3, profile_text[row], COLOR_WHITE, true);
 				}
-				move_list.pop_back();
-				move_list.pop_back();
-				move_list.pop_back();
-				move_list.push_back(op);
 			}
-		}
-
-		// APPLY VELOCITIES FOR SMOOTH ROTATION
-		yaw += yaw_vel;
-		yaw_vel /= 1.1;
-		pitch += pitch_vel;
-		pitch_vel /= 1.1;
-
-		// SMOOTHLY CLAMP VIEW TO PSEUDO-ISOMETRIC RANGE
-		float pitch_iso = 0.6f;
-		float yaw_iso = 0.6f;
-		if (pitch > pitch_iso) {
-			pitch = 0.99*pitch + 0.01*pitch_iso;
-		} else if (pitch < -pitch_iso) {
-			pitch = 0.99*pitch - 0.01*pitch_iso;
-		}
-		if (yaw > yaw_iso) {
-			yaw = 0.99*yaw + 0.01*yaw_iso;
-		} else if (yaw < -yaw_iso) {
-			yaw = 0.99*yaw - 0.01*yaw_iso;
-		}
-
-		if (yaw > glm::half_pi<float>() * 3) {
-			yaw -= glm::two_pi<float>();
-		}
-		if (yaw < -glm::half_pi<float>() * 3) {
-			yaw += glm::two_pi<float>();
-		}
-
-		// PITCH CANNOT GO ABOVE OR BELOW 2PI
-		pitch = glm::clamp(pitch, -glm::half_pi<float>() + 0.01f, glm::half_pi<float>() - 0.01f);
-
-		// INITIALIZE CAMERA
-		glm::vec3 camera;
 
-		// R = CAMERA RADIUS TO CUBE
-		float r = 8.0f;
-		camera.x = r * std::cos(pitch) * std::sin(yaw);
-		camera.y = r * std::sin(pitch);
-		camera.z = r * std::cos(pitch) * std::cos(yaw);
-
-		// SET VIEW AND ZBUFFER
-		glm::mat4 view = glm::lookAt(camera, glm::vec3(0.0f), glm::vec3(0, 1, 0));
-		zbuffer.assign(height, std::vector<float>(width, INFINITY));
-
-		// CLEAR SCREEN
-		for (int y = 0; y < height; y++) {
-			for (int x = 0; x < width; x++) {
-				auto& pixel = screen.PixelAt(x, y);
-				pixel.character = U' ';
+			// DISPLAY HELP
+			if (display_help) {
+				int help_x_start = width - 15;
+				int y = 1;
+
+				// HELP TEXT
+				static const std::vector<std::string> help_lines = [] {
+					std::vector<std::string> lines = {
+					" Controls",
+					" ----------",
+					" w/s: pitch",
+					" a/d: yaw",
+					" i/o: U / U'",
+					" p/;: R / R'",
+					" u/j: L / L'",
+					" k/l: F / F'",
+					" ,/.: B / B'",
+					" m/ : D / D'",
+					" q/e: Y / Y'",
+					" r/f: X / X'",
+					" x/c: Z / Z'",
+					" space: random",
+					" z: undo",
+					};
+					if (TURN_DEPTHS > 2) lines.push_back(" 2-" + std::to_string(TURN_DEPTHS) + ": layer");
+					if (TURN_DEPTHS == 2) lines.push_back(" 2: layer");
+					if (CUBE_N == 3) lines.push_back(" v: solve");
+					lines.push_back(" t: timings");
+					lines.push_back(" h: toggle help");
+					lines.push_back(" ^C: quit");
+					return lines;
+				}();
+
+				// THE WALL ONLY TAKES THE CAMERA AND DISPLAY KEYS
+				static const std::vector<std::string> wall_help_lines = {
+					" Controls",
+					" ----------",
+					" w/s: pitch",
+					" a/d: yaw",
+					" t: timings",
+					" h: toggle help",
+					" ^C: quit",
+				};
+
+				for (const std::string& line : wall_mode ? wall_help_lines : help_lines) {
+					screen.print(help_x_start, y, line.c_str(), COLOR_WHITE, true);
+					y++;
+				}
 			}
-		}
 
-		// INITIALIZE PROJECTION MATRIX
-		float fov = glm::radians(70.0f);
-		float aspectRatio = (float)width / (float)height / 2.0;
-		glm::mat4 proj = glm::perspective(fov, aspectRatio, 0.1f, 100.0f);
-
-		// RENDER CUBE UNITS
-		for (int i = 0; i < 27; i++) {
-			CubeUnit cube_unit = cube.units[i];
-			render_cubeunit(cube_unit, screen, proj, view, zbuffer);
+			// HAND THE FRAME TO THE WRITER (IT ONLY WRITES THE CELLS THAT CHANGED), THEN TAKE BACK AN OLDER FRAMEBUFFER
+			// TO DRAW THE NEXT ONE INTO, WHICH MAY STILL HAVE A SIZE FROM BEFORE A RESIZE
+			writer.publish(frame.screen);
+			frame.resize(width, height);
 		}
 
-		// DISPLAY FPS
-		std::string fps_text = "FPS: " + std::to_string(fps);
-		for (size_t i = 0; i < fps_text.size() && i < static_cast<size_t>(width - 4); ++i) {
-			auto& pixel = screen.PixelAt(i + 2, 1);
-			pixel.character = fps_text[i];
-			pixel.foreground_color = ftxui::Color::White;
-			pixel.bold = true;
-		}
+		// FRAMES THAT WERE NOT RENDERED WOULD ONLY DRAG THE FRAME STATISTICS DOWN
+		if (!scene_changed) frame_timer.cancel();
+		frame_timer.stop();
 
-		// DISPLAY MOVE LIST
-		for (size_t i = 0; i < move_list.size() && i < static_cast<size_t>(width - 4); ++i) {
-			auto& pixel = screen.PixelAt(i + 2, height-2);
-			pixel.character = move_list[i - ((move_list.size() > width - 4) ? (width - 4 - move_list.size()) : 0)];
-			pixel.foreground_color = ftxui::Color::White;
-			pixel.bold = true;
+		// PACE TO THE ADAPTIVE FRAME RATE, ONLY RENDERED FRAMES TELL THE PACER HOW EXPENSIVE A FRAME IS
+		// (THE WRITER THREAD'S TIME COUNTS TOO, A TERMINAL THAT CANNOT SHOW EVERY FRAME LOWERS THE RATE LIKE SLOW
+		// RENDERING DOES INSTEAD OF HAVING THE WRITER DROP THE FRAMES IT HAS NO TIME FOR)
+		std::chrono::duration<double> work = Clock::now() - frame_start;
+		if (scene_changed) pacer.record(std::max(work.count(), writer.output_seconds()));
+		auto frame_duration = std::chrono::duration<double>(pacer.frame_seconds());
+		if (work < frame_duration) {
+			std::this_thread::sleep_for(frame_duration - work);
 		}
 
-		// DISPLAY HELP
-		if (display_help) {
-			int help_x_start = width - 15;
-			int y = 1;
-
-			auto write_line = [&](std::string line, int y_offset) {
-				for (size_t i = 0; i < line.size() && (help_x_start + i) < width; i++) {
-					auto& pixel = screen.PixelAt(help_x_start + i, y_offset);
-					pixel.character = line[i];
-					pixel.foreground_color = ftxui::Color::White;
-					pixel.bold = true;
-				}
-			};
-
-			// HELP TEXT
-			write_line(" Controls", y++);
-			write_line(" ----------", y++);
-			write_line(" w/s: pitch", y++);
-			write_line(" a/d: yaw", y++);
-			write_line(" i/o: U / U'", y++);
-			write_line(" p/;: R / R'", y++);
-			write_line(" u/j: L / L'", y++);
-			write_line(" k/l: F / F'", y++);
-			write_line(" ,/.: B / B'", y++);
-			write_line(" m/ : D / D'", y++);
-			write_line(" q/e: Y / Y'", y++);
-			write_line(" r/f: X / X'", y++);
-			write_line(" x/c: Z / Z'", y++);
-			write_line(" space: random", y++);
-			write_line(" z: undo", y++);
-			write_line(" h: toggle help", y++);
-			write_line(" ^C: quit", y++);
-		}
-
-		// DISABLE CURSOR AND FLUSH SCREEN
-		std::cout << "\033[?25l";
-		std::cout << "\033[H";
-		std::cout << screen.ToString();
-		std::cout.flush();
-
-		// PREPARE TIME FOR NEXT FRAME CALCULATIONS
-		auto current_time = Clock::now();
-		std::chrono::duration<double> delta = current_time - last_time;
-
-		// CAP FRAMERATE TO 60FPS
-		if (delta < target_frame_duration) {
-			std::this_thread::sleep_for(target_frame_duration - delta);
-		}
-		current_time = Clock::now();
-		delta = current_time - last_time;
+		// UPDATE FPS (ONLY FOR FRAMES THAT WERE ACTUALLY RENDERED)
+		std::chrono::duration<double> delta = Clock::now() - frame_start;
+		if (scene_changed) fps = static_cast<int>(1.0 / delta.count());
+	}
 
-		// UPDATE FPS
-		fps = static_cast<int>(1.0 / delta.count());
-		last_time = current_time;
+	writer.stop();
+	restore_terminal();
+	if (!recorder.close()) {
+		std::cerr << "could not write the recording to " << record_path << "\n";
+		return 1;
+	}
+	if (profiler.tracing && !profiler.write_trace(trace_path)) {
+		std::cerr << "could not write trace to " << trace_path << "\n";
+		return 1;
 	}
+	return 0;
 }
-